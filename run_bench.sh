@@ -1,19 +1,33 @@
 # Installing dependencies if they are missing
-sudo apt install gcc
-
-if [ ! -d .venv ]; then
-  virtualenv .venv
-  source .venv/bin/activate
-  pip install pandas
-  pip install matplotlib
-  pip install seaborn
-else
-  source .venv/bin/activate
-fi
+sudo apt install g++
 
 # Building benchmark
-g++ seq_read_bench.cpp -o seq_read_bench
+# The commit is recorded in the JSON Lines output
+g++ -std=c++20 -O2 -DGIT_HASH="\"$(git describe --always --dirty 2>/dev/null || echo unknown)\"" \
+    seq_read_bench.cpp -o seq_read_bench || exit 1
 chmod +x ./seq_read_bench
 
 # Launching the benchmark
-python3 seq_read_bench.py
+# The binary creates the test file, runs the matrix and prints the summary
+# itself, so nothing but the benchmark runs in the guest. Arguments override
+# the defaults below (e.g. --file-size=10G --cache=direct).
+./seq_read_bench --create --file-size=1M --target=test_file.bin "$@"
+status=$?
+
+# Plots are optional and meant for the host: copy benchmark_results.csv
+# (and benchmark_timeseries.csv) out and run
+#   python3 seq_read_bench.py --plot benchmark_results.csv
+# PLOT=1 draws them here instead, installing the plotting libraries first.
+if [ -n "$PLOT" ]; then
+  if [ ! -d .venv ]; then
+    virtualenv .venv
+    source .venv/bin/activate
+    pip install pandas
+    pip install matplotlib
+    pip install seaborn
+  else
+    source .venv/bin/activate
+  fi
+  python3 seq_read_bench.py --plot benchmark_results.csv
+fi
+exit $status
@@ -3,143 +3,5980 @@
 #include <chrono>
 #include <string>
 #include <format>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include <barrier>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <iterator>
+#include <cmath>
+#include <utility>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
 
 #include <fcntl.h>  // For posix open flags
 #include <unistd.h> // For posix read
+#include <getopt.h> // For command line parsing
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/utsname.h>
+#include <sys/prctl.h>
+#include <sched.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <linux/io_uring.h>
+#include <linux/perf_event.h>
+#include <linux/mempolicy.h>
+#include <linux/fuse.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h> // SSE4.2 crc32
+#endif
 
-#define FILE_SIZE (1024 * 1024 * 64) // 64 MiB
-#define SMALL_CHUNK 100
-#define MEDIUM_CHUNK 1024
-#define INCREMENTAL 8192
-#define INCREMENTAL_START 8192
-#define LARGEST_CHUNK (256 * 1024)
+#define DEFAULT_CHUNKS "100,1K,8K..256K+8K" // 100 B, 1 KiB, then 8 KiB steps up to 256 KiB
+#define DEFAULT_RUNS 30
+#define DIRECT_IO_ALIGNMENT 4096 // Buffer alignment for O_DIRECT reads
+#define MAX_QUEUE_DEPTH 128
+#define MAX_IOVECS 1024 // UIO_MAXIOV, most iovecs a single preadv accepts
+#define GENERATE_BLOCK_SIZE (4 * 1024 * 1024) // Bytes per pwrite of the test file generator
+#define VERIFY_SPAN_SIZE (1024 * 1024) // Bytes per verified span of an mmap pass
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024) // Buffer granularity of the thp and hugetlb strategies
+#define ARENA_RESERVE (4ULL << 30) // Address space reserved for the arena buffer strategy
+#define MEM_NODE_NONE -1  // --mem-node not given, buffers are placed by first touch
+#define MEM_NODE_LOCAL -2 // Buffers bound to the node of their worker's --cpus entry
+#define OPEN_LOOP_SPIN_NS 100000 // Open-loop readers spin instead of sleeping this close to a start
+
+// Commit the binary was built from, passed in by run_bench.sh
+#ifndef GIT_HASH
+#define GIT_HASH "unknown"
+#endif
+
+// How the guest page cache is treated between runs
+enum class CacheMode {
+    Buffered,   // Plain O_RDONLY, runs after the first hit the page cache
+    Direct,     // O_DIRECT with aligned buffers, bypasses the page cache
+    Fadvise,    // POSIX_FADV_DONTNEED on the file before every run
+    DropCaches  // Write to /proc/sys/vm/drop_caches before every run
+};
+
+// Cache state a reported run started from
+enum class RunPhase {
+    None, // O_DIRECT, the page cache is not involved
+    Cold, // Caches were invalidated before the run
+    Warm  // The run found the file as the previous pass left it
+};
+
+// How parallel readers divide the work between them
+enum class ThreadLayout {
+    Slice, // Every thread preads its own contiguous slice of the test file
+    File   // Every thread reads its own copy, <test file>.<thread>
+};
+
+// I/O path used for the reads
+enum class Engine {
+    Sync,    // read(2), or pread(2) with several threads, queue depth 1 per thread
+    IoUring, // io_uring with registered buffers and a fixed file
+    Mmap,    // mmap(2) of the whole file, pages faulted in by touching them
+    Write,   // write(2)/pwrite(2) to a separate file with a durability policy
+    Metadata, // create/stat/open+read+close/readdir/unlink over a tree of small files
+    Splice,   // splice(2) file -> pipe -> /dev/null, no user space copy
+    Sendfile, // sendfile(2) to a unix socket pair drained by a second thread
+    CopyFileRange, // copy_file_range(2) to a second file, same or another filesystem
+    Preadv,   // preadv(2)/preadv2(2) gathering several chunk sized iovecs per call
+    FileSet,  // Many files read whole, threads share them through work-stealing queues
+    Mixed     // Classes of readers, appenders and metadata workers running at the same time
+};
+
+// A class of identical workers of the mixed engine
+enum class JobKind {
+    Read,     // pread of the worker's slice of the test file front to back
+    RandRead, // pread of uniformly random chunks of the worker's slice
+    Append,   // write(2) to the end of write_path with the --sync policy
+    Metadata  // create + stat + unlink of a small file under meta_root
+};
+
+struct JobClass {
+    JobKind kind;
+    int workers;
+};
+
+// When the write engine makes its data durable
+enum class SyncPolicy {
+    None,      // Never, data may still be in the guest or host page cache
+    Fdatasync, // fdatasync every sync_interval bytes and at the end
+    Fsync,     // One fsync after the last write
+    Dsync      // O_DSYNC, every write returns once durable
+};
+
+// Order in which the chunks of the file are read
+enum class AccessPattern {
+    Sequential, // Front to back
+    Reverse,    // Back to front
+    Strided,    // Chunks stride bytes apart, wrapping around until every chunk was read once
+    Uniform,    // Uniformly random chunk aligned offsets
+    Zipfian     // Zipf distributed chunk aligned offsets, hot chunks scattered over the file
+};
+
+// How the mmap engine faults the mapping in
+enum class MmapFault {
+    Demand,   // Plain mapping, every page faults on first access
+    Populate, // MAP_POPULATE prefaults the whole mapping inside mmap()
+    Cold      // Page cache dropped with FADV_DONTNEED right before mapping
+};
+
+enum class MmapAdvice {
+    Normal,
+    Sequential, // MADV_SEQUENTIAL
+    Hugepage    // MADV_HUGEPAGE
+};
+
+enum class MmapAccess {
+    Touch,   // Load one byte per page
+    Checksum // Sum every 64-bit word
+};
+
+// posix_fadvise hint given on the test file before every run
+enum class FadviseHint {
+    None,       // No hint, the file keeps the kernel default
+    Normal,     // POSIX_FADV_NORMAL
+    Sequential, // POSIX_FADV_SEQUENTIAL, doubles the readahead window
+    Random,     // POSIX_FADV_RANDOM, disables readahead
+    WillNeed    // POSIX_FADV_WILLNEED, starts reading the whole file right away
+};
+
+// One point of the readahead sweep of the sync engine
+struct ReadTuning {
+    FadviseHint fadvise = FadviseHint::None;
+    long long prefetch_window = 0; // readahead(2) this far ahead of the reader, 0: none
+    long long bdi_readahead_kb = -1; // read_ahead_kb of the backing device, negative: left alone
+};
+
+// Offered load of an open-loop run: reads per second, or bytes per second
+// turned into reads with the chunk size
+struct OfferedLoad {
+    double iops = 0;
+    long long bytes_per_second = 0;
+};
+
+// How worker chunk buffers are allocated
+enum class BufferStrategy {
+    Malloc,   // malloc (posix_memalign for O_DIRECT), faulted in by the first timed run
+    Populate, // Anonymous mmap with MAP_POPULATE, faulted in up front
+    Thp,      // 2 MiB aligned with MADV_HUGEPAGE (transparent huge pages), faulted in up front
+    Hugetlb,  // MAP_HUGETLB 2 MiB pages from the reserved hugetlbfs pool
+    Arena     // Slices of one page-aligned arena reused across chunk sizes, faulted in once
+};
+
+// Contents of generated test files
+enum class FillPattern {
+    Random, // Incompressible pseudo random words, a function of seed and offset
+    Zero    // Zero bytes, compressible and deduplicatable
+};
+
+// How read data is checked for correctness
+enum class VerifyMode {
+    None,
+    Pattern, // Compare against the data --generate writes for the same --seed
+    Crc32c   // Compare the crc32c of every read against a reference pass over the file
+};
+
+// When the check runs
+enum class VerifyPass {
+    Inline,  // Right after every read, inside the timed region
+    Separate // In a second pass after the timed region (for mmap: over the same mapping)
+};
+
+// A directory the whole matrix is run against, e.g. tmpfs, local ext4 or virtiofs
+struct BenchmarkTarget {
+    std::string name;
+    std::string directory;
+};
+
+struct BenchmarkConfig {
+    std::string target_path = "test_file.bin";
+    std::string target_name = "default"; // Recorded in the target column
+    std::vector<BenchmarkTarget> targets; // Empty: only target_path in the working directory
+    std::string jsonl_path; // Also write results and environment as JSON Lines here, empty: CSV only
+    std::vector<std::pair<std::string, std::string>> labels; // Free-form key=value pairs for the JSON Lines
+    long long file_size = 0; // Bytes read per pass, 0 means the size of the test file
+    std::vector<int> chunk_sizes;
+    int runs = DEFAULT_RUNS;
+    int warmup = 0; // Untimed passes before the measured runs
+    double ci_width = 0; // Stop once the 95% CI of the median is this narrow (relative), 0: always do all runs
+    int min_runs = 10; // Measured runs before the CI is checked
+    double time_budget = 0; // Seconds per configuration (chunk size, queue depth), 0 is unlimited
+    CacheMode cache_mode = CacheMode::Buffered;
+    std::string drop_hook; // Optional command run before every run (e.g. host-side drop caches)
+    bool phases = false; // Invalidate before the first reported run only, the later runs read warm
+    int threads = 1;
+    ThreadLayout thread_layout = ThreadLayout::Slice;
+    Engine engine = Engine::Sync;
+    std::vector<int> queue_depths = {1, 2, 4, 8, 16, 32, 64, 128}; // Swept by the io_uring engine
+    std::vector<int> iovec_counts = {1, 4, 16, 64}; // Swept by the preadv engine, iovecs per call
+    std::vector<int> rwf_flags = {0}; // Swept by the preadv engine, 0 is plain preadv
+    MmapFault mmap_fault = MmapFault::Demand;
+    MmapAdvice mmap_advice = MmapAdvice::Sequential;
+    MmapAccess mmap_access = MmapAccess::Checksum;
+    bool latency = true; // Time every read syscall / io_uring request
+    AccessPattern pattern = AccessPattern::Sequential;
+    long long stride = 1024 * 1024; // Strided pattern distance, rounded up to a multiple of the chunk size
+    double zipf_theta = 0.99;
+    uint64_t seed = 42; // Random patterns are reproducible for a given seed
+    int verbosity = 1;  // 0: errors only, 1: progress per chunk size, 2: every run
+    std::string write_path = "write_test_file.bin";
+    std::string copy_path = "copy_test_file.bin"; // copy_file_range destination, may be on another mount
+    SyncPolicy sync_policy = SyncPolicy::None;
+    long long sync_interval = 1024 * 1024;
+    std::string meta_root = "metadata_tree";
+    int meta_files = 10000;
+    int meta_dirs = 100;
+    long long meta_file_size = 4096;
+    std::string set_dir = "file_set"; // Files of the fileset engine, kept for later runs
+    int set_files = 100;
+    std::vector<long long> set_sizes = {1024 * 1024}; // Cycled over the files
+    bool perf = false; // Also read cycles/instructions/page faults via perf_event_open
+    bool generate = false; // Write the test file and exit instead of benchmarking
+    bool create = false; // Write the test file first when it is missing, never over an existing one
+    bool trace_fuse = false; // Count FUSE requests and virtqueue interrupts of every timed pass
+    FillPattern fill = FillPattern::Random;
+    int generate_threads = 1;
+    std::vector<JobClass> jobs = {{JobKind::Read, 4}, {JobKind::Append, 1}, {JobKind::Metadata, 1}};
+    VerifyMode verify = VerifyMode::None;
+    VerifyPass verify_pass = VerifyPass::Inline;
+    std::vector<FadviseHint> fadvise_hints = {FadviseHint::None}; // Readahead sweep, every combination is run
+    std::vector<long long> prefetch_windows = {0};
+    std::vector<long long> bdi_readaheads_kb = {-1};
+    ReadTuning tuning; // Sweep point currently measured
+    std::vector<OfferedLoad> rates; // Open-loop sweep of the sync engine, empty: closed loop
+    double rate_time = 5; // Seconds per open-loop run, or less if one pass over the file is shorter
+    std::vector<int> cpus; // Worker i runs on cpus[i % size], empty: unpinned
+    int mem_node = MEM_NODE_NONE; // NUMA node buffers are bound to, or MEM_NODE_LOCAL
+    std::vector<BufferStrategy> buffer_strategies = {BufferStrategy::Malloc}; // Swept around the whole matrix
+    double sample_interval_ms = 0; // Time series sampling period within a run, 0: off
+    BufferStrategy buffer_strategy = BufferStrategy::Malloc; // Sweep point currently measured
+};
+
+// Per-request latency percentiles of one run, in microseconds
+struct LatencySummary {
+    bool valid = false; // false for rows without per-request timing (mmap, --no-latency)
+    double p50_us = 0;
+    double p90_us = 0;
+    double p99_us = 0;
+    double p999_us = 0;
+    double max_us = 0;
+};
+
+// CPU spent by the whole process during one timed pass
+struct CpuUsage {
+    bool valid = false; // false for per-thread rows, getrusage only covers the process
+    double user_ms = 0;
+    double sys_ms = 0;
+    double ns_per_mib = -1; // (user + sys) per MiB moved, negative when no bytes were moved
+    long long voluntary_switches = 0;
+    long long involuntary_switches = 0;
+    long long cycles = -1; // perf counters, negative when --perf is off or the counter is unavailable
+    long long instructions = -1;
+    long long page_faults = -1;
+};
+
+// FUSE requests sent on the connection of the target and interrupts of its
+// virtio device during one timed pass, with --trace-fuse
+struct FuseTrace {
+    bool valid = false;            // false when the fuse tracepoints could not be enabled
+    long long requests = 0;        // Every opcode, including LOOKUP/GETATTR/OPEN around the reads
+    long long reads = 0;           // FUSE_READ requests sent
+    double read_kib = -1;          // Data per completed READ reply, negative when no READ completed
+    double vq_irqs_per_mib = -1;   // Virtqueue interrupts per MiB moved, negative without a virtio device
+};
+
+// Spread of the series a run belongs to (all measured runs of one chunk
+// size, queue depth or metadata phase). The median intervals are
+// distribution free, from order statistics.
+struct RunStatistics {
+    bool valid = false; // false for per-thread rows and series too short for an interval
+    double time_ci_low_ms = 0;
+    double time_ci_high_ms = 0;
+    double mbps_ci_low = 0;
+    double mbps_ci_high = 0;
+    bool outlier = false; // read time outside the Tukey fences (1.5 IQR) of the series
+};
+
+// Outcome of the data verification of one run
+struct VerifyResult {
+    bool valid = false; // false when --verify is off
+    double time_ms = 0; // Time spent verifying; inline checks are also part of read_time_ms
+    long long corrupt_reads = 0; // Reads (mmap: 1 MiB spans) whose data did not match
+};
+
+// Progress of a run at one sampler tick, cumulative since the run started
+struct ThroughputSample {
+    double time_ms;
+    uint64_t bytes;
+    uint64_t ops;
+};
+
+#define AGGREGATE_THREAD_ID -1 // thread_id of the row summarizing a whole run
 
 struct BenchmarkResult {
     int chunk_size;
     int run_number;
     double read_time_ms;
     double throughput_mbps;
+    double iops;
+    CacheMode cache_mode;
+    int threads;
+    int thread_id;
+    Engine engine;
+    int qd;
+    std::string variant; // Engine specific options, e.g. "populate/sequential/checksum" for mmap
+    AccessPattern pattern;
+    LatencySummary latency;
+    double durable_time_ms = -1; // Write engine: until the data is durable, negative when never synced
+    std::string target;
+    CpuUsage cpu;
+    RunStatistics stats;
+    VerifyResult verify;
+    int first_worker = 0; // Worker index of thread_id 0 (or of the only reader), for the placement below
+    int cpu_id = -1;      // CPU all workers of the row were pinned to, -1: unpinned or several
+    int numa_node = -1;   // Node their buffers were bound to (or local to), -1: unknown or several
+    BufferStrategy buffer = BufferStrategy::Malloc;
+    std::vector<ThroughputSample> samples; // --sample-interval time series of aggregate rows
+    RunPhase phase = RunPhase::None;
+    double ttfb_us = -1; // Timed start to the first data returned, negative when not measured
+    FuseTrace fuse;
+};
+
+// Log-linear (HDR style) latency histogram in nanoseconds. Every power of
+// two range is split into SUB_BUCKETS linear buckets, which bounds the
+// relative error to 1/SUB_BUCKETS. All storage is inline so recording on
+// the hot path never allocates.
+struct LatencyHistogram {
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t max;
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        std::memset(counts, 0, sizeof(counts));
+        total = 0;
+        max = 0;
+    }
+
+    static int bucket_index(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return (int)value;
+        }
+        int exponent = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+        return (exponent + 1) * SUB_BUCKETS + (int)((value >> exponent) - SUB_BUCKETS);
+    }
+
+    // Highest value that falls into the bucket
+    static uint64_t bucket_upper_bound(int index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        int exponent = index / SUB_BUCKETS - 1;
+        uint64_t sub_bucket = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub_bucket + 1) << exponent) - 1;
+    }
+
+    void record(uint64_t value_ns) {
+        counts[bucket_index(value_ns)]++;
+        total++;
+        if (value_ns > max) {
+            max = value_ns;
+        }
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max = std::max(max, other.max);
+    }
+
+    uint64_t percentile(double fraction) const {
+        uint64_t rank = (uint64_t)(fraction * total);
+        if (rank >= total) {
+            return max;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen > rank) {
+                return std::min(bucket_upper_bound(i), max);
+            }
+        }
+        return max;
+    }
+
+    LatencySummary summary() const {
+        LatencySummary latency;
+        if (total == 0) {
+            return latency;
+        }
+        latency.valid = true;
+        latency.p50_us = percentile(0.50) / 1000.0;
+        latency.p90_us = percentile(0.90) / 1000.0;
+        latency.p99_us = percentile(0.99) / 1000.0;
+        latency.p999_us = percentile(0.999) / 1000.0;
+        latency.max_us = max / 1000.0;
+        return latency;
+    }
+};
+
+// Cheap monotonic timestamp for per-request timing (vDSO, no NTP slewing)
+inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+    return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+// Samples getrusage and, with --perf, hardware/software counters around a
+// timed pass. Counters are opened once with inherit set, before any worker
+// thread is started, so threads spawned later are counted too. They keep
+// running and every pass takes the difference of two reads, which avoids
+// the reset semantics of inherited events; the reads stay outside the
+// timed region.
+struct CpuMeter {
+    static constexpr int COUNTERS = 3;
+    int perf_fds[COUNTERS] = {-1, -1, -1}; // cycles, instructions, page faults
+    long long perf_start[COUNTERS] = {};
+    struct rusage usage_start;
+
+    explicit CpuMeter(bool use_perf) {
+        if (!use_perf) {
+            return;
+        }
+        static bool warned = false;
+        const std::pair<uint32_t, uint64_t> events[COUNTERS] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        };
+        for (int i = 0; i < COUNTERS; i++) {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.inherit = 1;
+            attr.exclude_hv = 1;
+            perf_fds[i] = perf_event_open(&attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+            if (perf_fds[i] == -1 && (errno == EACCES || errno == EPERM)) {
+                // perf_event_paranoid >= 2 only allows user space counting
+                attr.exclude_kernel = 1;
+                perf_fds[i] = perf_event_open(&attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+            }
+            if (perf_fds[i] == -1 && !warned) {
+                std::cerr << "perf_event_open failed (" << strerror(errno) << "), some perf counters are not reported\n";
+                warned = true;
+            }
+        }
+    }
+
+    ~CpuMeter() {
+        for (int fd : perf_fds) {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+    }
+
+    CpuMeter(const CpuMeter&) = delete;
+    CpuMeter& operator=(const CpuMeter&) = delete;
+
+    static long long read_counter(int fd) {
+        uint64_t value = 0;
+        if (fd == -1 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+            return -1;
+        }
+        return (long long)value;
+    }
+
+    void start() {
+        for (int i = 0; i < COUNTERS; i++) {
+            perf_start[i] = read_counter(perf_fds[i]);
+        }
+        getrusage(RUSAGE_SELF, &usage_start);
+    }
+
+    CpuUsage stop(long long bytes) const {
+        struct rusage usage_end;
+        getrusage(RUSAGE_SELF, &usage_end);
+        CpuUsage cpu;
+        long long* counters[COUNTERS] = {&cpu.cycles, &cpu.instructions, &cpu.page_faults};
+        for (int i = 0; i < COUNTERS; i++) {
+            long long end = read_counter(perf_fds[i]);
+            *counters[i] = (end < 0 || perf_start[i] < 0) ? -1 : end - perf_start[i];
+        }
+
+        auto elapsed_ms = [](const struct timeval& begin, const struct timeval& end) {
+            return (end.tv_sec - begin.tv_sec) * 1000.0 + (end.tv_usec - begin.tv_usec) / 1000.0;
+        };
+        cpu.valid = true;
+        cpu.user_ms = elapsed_ms(usage_start.ru_utime, usage_end.ru_utime);
+        cpu.sys_ms = elapsed_ms(usage_start.ru_stime, usage_end.ru_stime);
+        cpu.voluntary_switches = usage_end.ru_nvcsw - usage_start.ru_nvcsw;
+        cpu.involuntary_switches = usage_end.ru_nivcsw - usage_start.ru_nivcsw;
+        if (bytes > 0) {
+            cpu.ns_per_mib = (cpu.user_ms + cpu.sys_ms) * 1e6 / (bytes / (1024.0 * 1024.0));
+        }
+        return cpu;
+    }
+};
+
+bool read_text_file(const std::string& path, std::string& text) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    text.clear();
+    char block[4096];
+    ssize_t n;
+    while ((n = read(fd, block, sizeof(block))) > 0) {
+        text.append(block, n);
+    }
+    close(fd);
+    return n == 0;
+}
+
+#define TRACE_INSTANCE "seq_read_bench"
+#define TRACE_BUFFER_KB 8192 // Per CPU, room for about 100k FUSE requests
+
+// With --trace-fuse, records the fuse:fuse_request_send/end tracepoints of
+// the target's FUSE connection around a timed pass, in a tracefs instance
+// of its own so a system wide trace is not disturbed. The events are only
+// parsed after the pass; while it runs, tracing costs one ring buffer write
+// per event. The size of a READ is taken from its reply, so it is the data
+// the daemon returned rather than the size asked for, and the interrupts
+// are the used buffer notifications of the virtio device (virtiofs, or
+// virtio-blk below a local filesystem) from /proc/interrupts. Notifications
+// to the device need a kprobe on virtqueue_notify and are not counted.
+struct FuseTracer {
+    std::string instance; // tracefs instance directory, empty when FUSE requests are not traced
+    std::string virtio_device; // e.g. "virtio1", empty when the target is not on a virtio device
+    long long irqs_start = 0;
+    long long overrun_start = 0;
+
+    FuseTracer(const BenchmarkConfig& config, const std::string& path) {
+        struct stat st;
+        if (!config.trace_fuse || stat(path.c_str(), &st) == -1) {
+            return;
+        }
+        virtio_device = find_virtio_device(st.st_dev);
+
+        static bool warned = false;
+        std::string root;
+        for (const char* candidate : {"/sys/kernel/tracing", "/sys/kernel/debug/tracing"}) {
+            if (access((std::string(candidate) + "/instances").c_str(), F_OK) == 0) {
+                root = candidate;
+                break;
+            }
+        }
+        if (root.empty()) {
+            if (!warned) {
+                std::cerr << "tracefs is not mounted (mount -t tracefs nodev /sys/kernel/tracing), "
+                             "FUSE requests are not traced\n";
+                warned = true;
+            }
+            return;
+        }
+        std::string dir = root + "/instances/" TRACE_INSTANCE;
+        if (mkdir(dir.c_str(), 0755) == -1 && errno != EEXIST) {
+            if (!warned) {
+                std::cerr << "Could not create tracefs instance " << dir << " (" << strerror(errno)
+                          << "), FUSE requests are not traced\n";
+                warned = true;
+            }
+            return;
+        }
+        // The connection id of the tracepoints is the kernel encoding of st_dev
+        unsigned connection = (major(st.st_dev) << 20) | minor(st.st_dev);
+        if (!write_control(dir + "/buffer_size_kb", std::to_string(TRACE_BUFFER_KB))
+            || !write_control(dir + "/events/fuse/filter", std::format("connection == {}", connection))) {
+            if (!warned) {
+                std::cerr << "Could not set up the fuse tracepoints in " << dir << " (" << strerror(errno)
+                          << "), FUSE requests are not traced\n";
+                warned = true;
+            }
+            rmdir(dir.c_str());
+            return;
+        }
+        instance = dir;
+    }
+
+    ~FuseTracer() {
+        if (!instance.empty()) {
+            write_control(instance + "/events/fuse/enable", "0");
+            rmdir(instance.c_str());
+        }
+    }
+
+    FuseTracer(const FuseTracer&) = delete;
+    FuseTracer& operator=(const FuseTracer&) = delete;
+
+    static bool write_control(const std::string& path, const std::string& text) {
+        int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+        if (fd == -1) {
+            return false;
+        }
+        bool written = write(fd, text.data(), text.size()) == (ssize_t)text.size();
+        int saved_errno = errno;
+        close(fd);
+        errno = saved_errno;
+        return written;
+    }
+
+    // Name of the virtio device behind dev: the virtiofs device for the
+    // anonymous devices of FUSE mounts (the first one if there are several),
+    // otherwise the virtio-blk device above the block device in sysfs
+    static std::string find_virtio_device(dev_t dev) {
+        auto is_virtio = [](const std::string& name) {
+            return name.size() > 6 && name.compare(0, 6, "virtio") == 0
+                   && std::all_of(name.begin() + 6, name.end(), ::isdigit);
+        };
+        if (major(dev) == 0) {
+            DIR* dir = opendir("/sys/bus/virtio/drivers/virtio_fs");
+            std::string found;
+            while (dir != NULL && found.empty()) {
+                struct dirent* entry = readdir(dir);
+                if (entry == NULL) {
+                    break;
+                }
+                if (is_virtio(entry->d_name)) {
+                    found = entry->d_name;
+                }
+            }
+            if (dir != NULL) {
+                closedir(dir);
+            }
+            return found;
+        }
+        char resolved[PATH_MAX];
+        std::string link = std::format("/sys/dev/block/{}:{}", major(dev), minor(dev));
+        if (realpath(link.c_str(), resolved) == NULL) {
+            return "";
+        }
+        // e.g. /sys/devices/pci0000:00/0000:00:02.0/virtio1/block/vda/vda1
+        std::string found;
+        std::string sysfs_path = resolved;
+        size_t start = 0;
+        while (start < sysfs_path.size()) {
+            size_t end = std::min(sysfs_path.find('/', start), sysfs_path.size());
+            std::string component = sysfs_path.substr(start, end - start);
+            if (is_virtio(component)) {
+                found = component;
+            }
+            start = end + 1;
+        }
+        return found;
+    }
+
+    // Interrupts of all virtqueues of the device (its config interrupt
+    // excluded), summed over the CPUs
+    long long virtio_irqs() const {
+        std::string text;
+        if (virtio_device.empty() || !read_text_file("/proc/interrupts", text)) {
+            return -1;
+        }
+        std::string prefix = virtio_device + "-";
+        long long total = 0;
+        size_t line_start = 0;
+        while (line_start < text.size()) {
+            size_t line_end = text.find('\n', line_start);
+            if (line_end == std::string::npos) {
+                line_end = text.size();
+            }
+            std::string line = text.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+
+            // " 36:     148384  PCI-MSIX-0000:00:02.0   1-edge      virtio1-req.0"
+            size_t name_start = line.find_last_of(' ') + 1;
+            size_t colon = line.find(':');
+            if (colon == std::string::npos || line.compare(name_start, prefix.size(), prefix) != 0
+                || line.compare(name_start + prefix.size(), std::string::npos, "config") == 0) {
+                continue;
+            }
+            const char* field = line.c_str() + colon + 1;
+            char* field_end;
+            for (long long count = strtoll(field, &field_end, 10); field_end != field;
+                 count = strtoll(field, &field_end, 10)) {
+                total += count;
+                field = field_end;
+            }
+        }
+        return total;
+    }
+
+    // Events dropped because the ring buffer wrapped, over all CPUs
+    long long overruns() const {
+        long long total = 0;
+        for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); cpu++) {
+            std::string text;
+            if (!read_text_file(std::format("{}/per_cpu/cpu{}/stats", instance, cpu), text)) {
+                continue;
+            }
+            size_t at = text.find("overrun: ");
+            if (at != std::string::npos) {
+                total += std::atoll(text.c_str() + at + 9);
+            }
+        }
+        return total;
+    }
+
+    void start() {
+        irqs_start = virtio_irqs();
+        if (!instance.empty()) {
+            write_control(instance + "/trace", "");
+            overrun_start = overruns();
+            write_control(instance + "/events/fuse/enable", "1");
+        }
+    }
+
+    FuseTrace stop(long long bytes) const {
+        FuseTrace trace;
+        if (!instance.empty()) {
+            write_control(instance + "/events/fuse/enable", "0");
+        }
+        long long irqs_end = virtio_irqs();
+        if (irqs_start >= 0 && irqs_end >= 0 && bytes > 0) {
+            trace.vq_irqs_per_mib = (irqs_end - irqs_start) / (bytes / (1024.0 * 1024.0));
+        }
+
+        std::string text;
+        if (instance.empty() || !read_text_file(instance + "/trace", text)) {
+            return trace;
+        }
+        static bool warned = false;
+        if (overruns() != overrun_start && !warned) {
+            std::cerr << "FUSE trace buffer overran, request counts are lower bounds\n";
+            warned = true;
+        }
+
+        // The send event carries the opcode and the end event the reply
+        // length, so READs are matched by their unique id
+        std::unordered_set<unsigned long long> pending_reads;
+        long long completed_reads = 0;
+        long long read_bytes = 0;
+        size_t line_start = 0;
+        while (line_start < text.size()) {
+            size_t line_end = text.find('\n', line_start);
+            if (line_end == std::string::npos) {
+                line_end = text.size();
+            }
+            std::string line = text.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+
+            unsigned long long unique;
+            unsigned opcode;
+            unsigned len;
+            int error;
+            const char* event;
+            if ((event = strstr(line.c_str(), "fuse_request_send: ")) != NULL) {
+                if (sscanf(event, "fuse_request_send: connection %*u req %llu opcode %u", &unique, &opcode) == 2) {
+                    trace.requests++;
+                    if (opcode == FUSE_READ) {
+                        trace.reads++;
+                        pending_reads.insert(unique);
+                    }
+                }
+            } else if ((event = strstr(line.c_str(), "fuse_request_end: ")) != NULL) {
+                if (sscanf(event, "fuse_request_end: connection %*u req %llu len %u error %d", &unique, &len,
+                           &error) == 3
+                    && pending_reads.erase(unique) > 0 && error == 0 && len >= sizeof(struct fuse_out_header)) {
+                    completed_reads++;
+                    read_bytes += len - sizeof(struct fuse_out_header);
+                }
+            }
+        }
+        trace.valid = true;
+        if (completed_reads > 0) {
+            trace.read_kib = read_bytes / 1024.0 / completed_reads;
+        }
+        return trace;
+    }
+};
+
+// Bytes and reads done by one worker. Only the worker writes it (plain
+// load + store, no locked instruction) and the sampler only reads it; each
+// counter has its own cache line so workers do not share one.
+struct alignas(64) ProgressCounter {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> ops{0};
+
+    void add(uint64_t done) {
+        bytes.store(bytes.load(std::memory_order_relaxed) + done, std::memory_order_relaxed);
+        ops.store(ops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// With --sample-interval, a thread that wakes every interval of a run and
+// records the sum of the worker counters. It sleeps on absolute
+// CLOCK_MONOTONIC deadlines, so a late wakeup does not shift later ticks.
+struct ThroughputSampler {
+    uint64_t interval_ns;
+    int workers;
+    std::unique_ptr<ProgressCounter[]> counters;
+    std::vector<ThroughputSample> samples;
+    std::atomic<bool> running = false;
+    std::thread thread;
+    uint64_t start_ns = 0;
+
+    ThroughputSampler(const BenchmarkConfig& config, int workers = 1)
+        : interval_ns((uint64_t)(config.sample_interval_ms * 1e6)), workers(workers),
+          counters(new ProgressCounter[workers]) {}
+
+    // Runs abandoned halfway (a rejected O_DIRECT size) never call stop
+    ~ThroughputSampler() {
+        if (thread.joinable()) {
+            running = false;
+            thread.join();
+        }
+    }
+
+    static uint64_t monotonic_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+    void sample() {
+        ThroughputSample point = {(monotonic_ns() - start_ns) / 1e6, 0, 0};
+        for (int i = 0; i < workers; i++) {
+            point.bytes += counters[i].bytes.load(std::memory_order_relaxed);
+            point.ops += counters[i].ops.load(std::memory_order_relaxed);
+        }
+        samples.push_back(point);
+    }
+
+    // Starts sampling a run and returns the worker counters, NULL when
+    // sampling is off so the hot loops skip the update
+    ProgressCounter* start() {
+        if (interval_ns == 0) {
+            return NULL;
+        }
+        for (int i = 0; i < workers; i++) {
+            counters[i].bytes = 0;
+            counters[i].ops = 0;
+        }
+        samples.clear();
+        running = true;
+        start_ns = monotonic_ns();
+        thread = std::thread([this]() {
+            for (uint64_t tick = 1; running.load(std::memory_order_relaxed); tick++) {
+                uint64_t deadline = start_ns + tick * interval_ns;
+                struct timespec wake = {(time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull)};
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {
+                }
+                if (running.load(std::memory_order_relaxed)) {
+                    sample();
+                }
+                // Ticks missed while the CPU was busy are dropped, not
+                // caught up as a burst of empty intervals
+                tick = std::max(tick, (monotonic_ns() - start_ns) / interval_ns);
+            }
+        });
+        return counters.get();
+    }
+
+    // Ends the run with a last sample and hands over its time series
+    std::vector<ThroughputSample> stop() {
+        if (interval_ns == 0) {
+            return {};
+        }
+        running = false;
+        thread.join();
+        sample();
+        return std::move(samples);
+    }
+};
+
+// Word at index of the generated data (splitmix64 finalizer of the
+// scaled index). Every word depends only on its position, so any block can be
+// generated on its own and the fill loop carries no dependency between
+// iterations, which leaves it to the compiler's vectorizer.
+inline uint64_t pattern_word(uint64_t seed, uint64_t index) {
+    uint64_t z = index * 0x9e3779b97f4a7c15ull + seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Fills size bytes of generated data starting at file offset (a multiple of 8)
+void fill_pattern(void* buffer, size_t size, uint64_t offset, FillPattern fill, uint64_t seed) {
+    if (fill == FillPattern::Zero) {
+        std::memset(buffer, 0, size);
+        return;
+    }
+    uint64_t* words = (uint64_t*)buffer;
+    uint64_t first = offset / sizeof(uint64_t);
+    size_t count = size / sizeof(uint64_t);
+    for (size_t i = 0; i < count; i++) {
+        words[i] = pattern_word(seed, first + i);
+    }
+    if (size % sizeof(uint64_t) != 0) {
+        uint64_t last = pattern_word(seed, first + count);
+        std::memcpy(words + count, &last, size % sizeof(uint64_t));
+    }
+}
+
+// Offsets of every read of one pass over [region_start, region_end).
+// Non-sequential offsets are generated into a flat array before the timed
+// region; sequential offsets are computed on the fly so tiny chunks over
+// huge files do not need gigabytes of offsets.
+struct AccessPlan {
+    bool sequential;
+    int chunk_size;
+    long long region_start;
+    long long region_end;
+    size_t ops;
+    long long bytes;
+    std::vector<off_t> offsets;
+
+    off_t offset(size_t op) const {
+        return sequential ? region_start + (off_t)op * chunk_size : offsets[op];
+    }
+
+    size_t length(size_t op) const {
+        return (size_t)std::min<long long>(chunk_size, region_end - offset(op));
+    }
+};
+
+// Zipfian rank generator after Gray et al., "Quickly generating
+// billion-record synthetic databases" (the one YCSB uses)
+struct ZipfianGenerator {
+    uint64_t items;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+
+    ZipfianGenerator(uint64_t items, double theta) : items(items), theta(theta) {
+        zetan = 0;
+        for (uint64_t i = 1; i <= items; i++) {
+            zetan += 1.0 / std::pow((double)i, theta);
+        }
+        double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / items, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+
+    uint64_t next(std::mt19937_64& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta)) {
+            return 1;
+        }
+        return std::min<uint64_t>(items - 1, (uint64_t)(items * std::pow(eta * u - eta + 1.0, alpha)));
+    }
+};
+
+AccessPlan plan_accesses(const BenchmarkConfig& config, int chunk_size, long long region_start,
+                         long long region_length, uint64_t seed) {
+    AccessPlan plan;
+    plan.sequential = config.pattern == AccessPattern::Sequential;
+    plan.chunk_size = chunk_size;
+    plan.region_start = region_start;
+    plan.region_end = region_start + region_length;
+
+    uint64_t chunks = (region_length + chunk_size - 1) / chunk_size;
+    plan.ops = chunks;
+    if (plan.sequential) {
+        plan.bytes = region_length;
+        return plan;
+    }
+
+    plan.offsets.reserve(chunks);
+    std::mt19937_64 rng(seed);
+    switch (config.pattern) {
+        case AccessPattern::Sequential:
+            break;
+        case AccessPattern::Reverse:
+            for (uint64_t i = chunks; i > 0; i--) {
+                plan.offsets.push_back(region_start + (off_t)(i - 1) * chunk_size);
+            }
+            break;
+        case AccessPattern::Strided: {
+            uint64_t stride_chunks = std::max<long long>(1, (config.stride + chunk_size - 1) / chunk_size);
+            for (uint64_t phase = 0; phase < stride_chunks && phase < chunks; phase++) {
+                for (uint64_t i = phase; i < chunks; i += stride_chunks) {
+                    plan.offsets.push_back(region_start + (off_t)i * chunk_size);
+                }
+            }
+            break;
+        }
+        case AccessPattern::Uniform: {
+            std::uniform_int_distribution<uint64_t> distribution(0, chunks - 1);
+            for (uint64_t i = 0; i < chunks; i++) {
+                plan.offsets.push_back(region_start + (off_t)distribution(rng) * chunk_size);
+            }
+            break;
+        }
+        case AccessPattern::Zipfian: {
+            // Scatter the hot ranks so they do not sit next to each other:
+            // a seeded permutation, so every rank has a chunk of its own
+            std::vector<uint64_t> rank_chunk(chunks);
+            for (uint64_t i = 0; i < chunks; i++) {
+                rank_chunk[i] = i;
+            }
+            std::shuffle(rank_chunk.begin(), rank_chunk.end(), rng);
+            std::vector<bool> reachable(chunks);
+            for (uint64_t chunk : rank_chunk) {
+                reachable[chunk] = true;
+            }
+            if (std::find(reachable.begin(), reachable.end(), false) != reachable.end()) {
+                std::cerr << "Zipfian rank permutation does not reach every chunk\n";
+                std::exit(EXIT_FAILURE);
+            }
+
+            ZipfianGenerator zipfian(chunks, config.zipf_theta);
+            for (uint64_t i = 0; i < chunks; i++) {
+                uint64_t chunk = rank_chunk[zipfian.next(rng)];
+                plan.offsets.push_back(region_start + (off_t)chunk * chunk_size);
+            }
+            break;
+        }
+    }
+
+    plan.bytes = 0;
+    for (size_t op = 0; op < plan.ops; op++) {
+        plan.bytes += plan.length(op);
+    }
+    return plan;
+}
+
+const char* cache_mode_name(CacheMode mode) {
+    switch (mode) {
+        case CacheMode::Buffered:   return "buffered";
+        case CacheMode::Direct:     return "direct";
+        case CacheMode::Fadvise:    return "fadvise";
+        case CacheMode::DropCaches: return "drop_caches";
+    }
+    return "unknown";
+}
+
+const char* run_phase_name(RunPhase phase) {
+    switch (phase) {
+        case RunPhase::None: return "";
+        case RunPhase::Cold: return "cold";
+        case RunPhase::Warm: return "warm";
+    }
+    return "unknown";
+}
+
+// Every run invalidates in the fadvise and drop_caches modes and with a
+// drop hook, --phases only does so before the first reported one
+RunPhase run_phase(const BenchmarkConfig& config, int run_number) {
+    if (config.cache_mode == CacheMode::Direct) {
+        return RunPhase::None;
+    }
+    bool invalidating = config.cache_mode != CacheMode::Buffered || !config.drop_hook.empty();
+    return invalidating && (!config.phases || run_number == 1) ? RunPhase::Cold : RunPhase::Warm;
+}
+
+// Benchmark of one chunk size (all its runs and sweep points)
+typedef void (*ChunkBenchmark)(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config);
+
+// Benchmark of one point of the matrix (target, buffer strategy): every
+// chunk size and readahead tuning of a read engine, or the whole pass of
+// the mmap and metadata engines
+typedef void (*EngineBenchmark)(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config);
+
+#define EXTRA_ENGINE_BASE 64 // Engine values of in-house engines start here
+
+struct EngineInfo {
+    Engine engine;
+    const char* name; // --engine and the engine column
+    EngineBenchmark benchmark;
+};
+
+// Every engine --engine can select, filled before main by the
+// EngineRegistration objects in declaration order
+std::vector<EngineInfo>& engine_registry() {
+    static std::vector<EngineInfo> engines;
+    return engines;
+}
+
+struct EngineRegistration {
+    EngineRegistration(Engine engine, const char* name, EngineBenchmark benchmark) {
+        engine_registry().push_back({engine, name, benchmark});
+    }
+};
+
+const EngineInfo* find_engine(Engine engine) {
+    for (const EngineInfo& info : engine_registry()) {
+        if (info.engine == engine) {
+            return &info;
+        }
+    }
+    return NULL;
+}
+
+const EngineInfo* find_engine(const std::string& name) {
+    for (const EngineInfo& info : engine_registry()) {
+        if (name == info.name) {
+            return &info;
+        }
+    }
+    return NULL;
+}
+
+const char* engine_name(Engine engine) {
+    const EngineInfo* info = find_engine(engine);
+    return info ? info->name : "unknown";
+}
+
+const char* sync_policy_name(SyncPolicy policy) {
+    switch (policy) {
+        case SyncPolicy::None:      return "none";
+        case SyncPolicy::Fdatasync: return "fdatasync";
+        case SyncPolicy::Fsync:     return "fsync";
+        case SyncPolicy::Dsync:     return "dsync";
+    }
+    return "unknown";
+}
+
+// preadv engine flags, "none" is plain preadv(2)
+const char* rwf_flag_name(int flag) {
+    switch (flag) {
+        case 0:          return "none";
+        case RWF_NOWAIT: return "nowait";
+        case RWF_HIPRI:  return "hipri";
+    }
+    return "unknown";
+}
+
+bool parse_rwf_flag(const std::string& name, int& flag) {
+    for (int candidate : {0, RWF_NOWAIT, RWF_HIPRI}) {
+        if (name == rwf_flag_name(candidate)) {
+            flag = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* fill_pattern_name(FillPattern fill) {
+    switch (fill) {
+        case FillPattern::Random: return "random";
+        case FillPattern::Zero:   return "zero";
+    }
+    return "unknown";
+}
+
+const char* buffer_strategy_name(BufferStrategy strategy) {
+    switch (strategy) {
+        case BufferStrategy::Malloc:   return "malloc";
+        case BufferStrategy::Populate: return "populate";
+        case BufferStrategy::Thp:      return "thp";
+        case BufferStrategy::Hugetlb:  return "hugetlb";
+        case BufferStrategy::Arena:    return "arena";
+    }
+    return "unknown";
+}
+
+const char* job_kind_name(JobKind kind) {
+    switch (kind) {
+        case JobKind::Read:     return "read";
+        case JobKind::RandRead: return "randread";
+        case JobKind::Append:   return "append";
+        case JobKind::Metadata: return "metadata";
+    }
+    return "unknown";
+}
+
+// Recorded in the variant column, e.g. "read:4+append:1+metadata:1"
+std::string job_list_name(const std::vector<JobClass>& jobs) {
+    std::string name;
+    for (const JobClass& job : jobs) {
+        name += std::format("{}{}:{}", name.empty() ? "" : "+", job_kind_name(job.kind), job.workers);
+    }
+    return name;
+}
+
+const char* verify_mode_name(VerifyMode mode) {
+    switch (mode) {
+        case VerifyMode::None:    return "none";
+        case VerifyMode::Pattern: return "pattern";
+        case VerifyMode::Crc32c:  return "crc32c";
+    }
+    return "unknown";
+}
+
+const char* verify_pass_name(VerifyPass pass) {
+    switch (pass) {
+        case VerifyPass::Inline:   return "inline";
+        case VerifyPass::Separate: return "separate";
+    }
+    return "unknown";
+}
+
+const char* mmap_fault_name(MmapFault fault) {
+    switch (fault) {
+        case MmapFault::Demand:   return "demand";
+        case MmapFault::Populate: return "populate";
+        case MmapFault::Cold:     return "cold";
+    }
+    return "unknown";
+}
+
+const char* mmap_advice_name(MmapAdvice advice) {
+    switch (advice) {
+        case MmapAdvice::Normal:     return "normal";
+        case MmapAdvice::Sequential: return "sequential";
+        case MmapAdvice::Hugepage:   return "hugepage";
+    }
+    return "unknown";
+}
+
+const char* mmap_access_name(MmapAccess access) {
+    switch (access) {
+        case MmapAccess::Touch:    return "touch";
+        case MmapAccess::Checksum: return "checksum";
+    }
+    return "unknown";
+}
+
+const char* fadvise_hint_name(FadviseHint hint) {
+    switch (hint) {
+        case FadviseHint::None:       return "none";
+        case FadviseHint::Normal:     return "normal";
+        case FadviseHint::Sequential: return "sequential";
+        case FadviseHint::Random:     return "random";
+        case FadviseHint::WillNeed:   return "willneed";
+    }
+    return "unknown";
+}
+
+bool parse_fadvise_hint(const std::string& name, FadviseHint& hint) {
+    for (FadviseHint candidate : {FadviseHint::None, FadviseHint::Normal, FadviseHint::Sequential,
+                                  FadviseHint::Random, FadviseHint::WillNeed}) {
+        if (name == fadvise_hint_name(candidate)) {
+            hint = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Short size label, e.g. 512, 64K or 1M
+std::string size_label(long long size) {
+    const char* units[] = {"", "K", "M", "G"};
+    int unit = 0;
+    while (unit < 3 && size >= 1024 && size % 1024 == 0) {
+        size /= 1024;
+        unit++;
+    }
+    return std::to_string(size) + units[unit];
+}
+
+// e.g. "rate=5000iops" or "rate=200M/s"
+std::string offered_load_name(const OfferedLoad& load) {
+    if (load.bytes_per_second > 0) {
+        return "rate=" + size_label(load.bytes_per_second) + "/s";
+    }
+    return std::format("rate={}iops", load.iops);
+}
+
+// Recorded in the variant column, e.g. "fadvise=random/prefetch=1M/read_ahead_kb=128";
+// empty when nothing is tuned
+std::string read_tuning_name(const ReadTuning& tuning) {
+    std::string name;
+    auto add = [&](const std::string& part) {
+        name += (name.empty() ? "" : "/") + part;
+    };
+    if (tuning.fadvise != FadviseHint::None) {
+        add(std::string("fadvise=") + fadvise_hint_name(tuning.fadvise));
+    }
+    if (tuning.prefetch_window > 0) {
+        add("prefetch=" + size_label(tuning.prefetch_window));
+    }
+    if (tuning.bdi_readahead_kb >= 0) {
+        add("read_ahead_kb=" + std::to_string(tuning.bdi_readahead_kb));
+    }
+    return name;
+}
+
+const char* access_pattern_name(AccessPattern pattern) {
+    switch (pattern) {
+        case AccessPattern::Sequential: return "sequential";
+        case AccessPattern::Reverse:    return "reverse";
+        case AccessPattern::Strided:    return "strided";
+        case AccessPattern::Uniform:    return "uniform";
+        case AccessPattern::Zipfian:    return "zipfian";
+    }
+    return "unknown";
+}
+
+bool parse_access_pattern(const std::string& name, AccessPattern& pattern) {
+    for (AccessPattern candidate : {AccessPattern::Sequential, AccessPattern::Reverse, AccessPattern::Strided,
+                                    AccessPattern::Uniform, AccessPattern::Zipfian}) {
+        if (name == access_pattern_name(candidate)) {
+            pattern = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_cache_mode(const std::string& name, CacheMode& mode) {
+    for (CacheMode candidate : {CacheMode::Buffered, CacheMode::Direct,
+                                CacheMode::Fadvise, CacheMode::DropCaches}) {
+        if (name == cache_mode_name(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+#define CSV_HEADER "chunk_size,run_number,read_time_ms,throughput_mbps,iops,cache_mode,threads,thread_id," \
+                   "engine,qd,variant,pattern,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us," \
+                   "durable_time_ms,target,cpu_user_ms,cpu_sys_ms,cpu_ns_per_mib,vol_ctx_switches," \
+                   "invol_ctx_switches,cycles,instructions,page_faults,ci_low_ms,ci_high_ms,ci_low_mbps," \
+                   "ci_high_mbps,outlier,verify_time_ms,corrupt_reads,cpu,numa_node,buffer," \
+                   "phase,ttfb_us,fuse_requests,fuse_reads,fuse_read_kib,vq_irqs_per_mib\n"
+
+// Appends one CSV row to out
+void format_result(std::string& out, const struct BenchmarkResult& result) {
+    std::string latency_str = ",,,,";
+    if (result.latency.valid) {
+        latency_str = std::format("{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}",
+            result.latency.p50_us,
+            result.latency.p90_us,
+            result.latency.p99_us,
+            result.latency.p999_us,
+            result.latency.max_us
+        );
+    }
+
+    std::string durable_str;
+    if (result.durable_time_ms >= 0) {
+        durable_str = std::format("{:.3f}", result.durable_time_ms);
+    }
+
+    // Missing counters leave their columns empty
+    auto counter_str = [](long long value) { return value < 0 ? std::string() : std::to_string(value); };
+    std::string cpu_str = ",,,,,,,";
+    if (result.cpu.valid) {
+        cpu_str = std::format("{:.3f},{:.3f},{},{},{},{},{},{}",
+            result.cpu.user_ms,
+            result.cpu.sys_ms,
+            result.cpu.ns_per_mib < 0 ? std::string() : std::format("{:.0f}", result.cpu.ns_per_mib),
+            result.cpu.voluntary_switches,
+            result.cpu.involuntary_switches,
+            counter_str(result.cpu.cycles),
+            counter_str(result.cpu.instructions),
+            counter_str(result.cpu.page_faults)
+        );
+    }
+
+    std::string stats_str = ",,,,";
+    if (result.stats.valid) {
+        stats_str = std::format("{:.3f},{:.3f},{:.3f},{:.3f},{}",
+            result.stats.time_ci_low_ms,
+            result.stats.time_ci_high_ms,
+            result.stats.mbps_ci_low,
+            result.stats.mbps_ci_high,
+            result.stats.outlier ? 1 : 0
+        );
+    }
+
+    std::string verify_str = ",";
+    if (result.verify.valid) {
+        verify_str = std::format("{:.3f},{}", result.verify.time_ms, result.verify.corrupt_reads);
+    }
+
+    auto placement_str = [](int value) { return value < 0 ? std::string() : std::to_string(value); };
+
+    std::string ttfb_str;
+    if (result.ttfb_us >= 0) {
+        ttfb_str = std::format("{:.3f}", result.ttfb_us);
+    }
+
+    std::string fuse_str = ",,";
+    if (result.fuse.valid) {
+        fuse_str = std::format("{},{},{}", result.fuse.requests, result.fuse.reads,
+                               result.fuse.read_kib < 0 ? std::string() : std::format("{:.1f}", result.fuse.read_kib));
+    }
+    std::string vq_str;
+    if (result.fuse.vq_irqs_per_mib >= 0) {
+        vq_str = std::format("{:.2f}", result.fuse.vq_irqs_per_mib);
+    }
+
+    std::format_to(std::back_inserter(out), "{},{},{:.3f},{:.3f},{:.1f},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n",
+        result.chunk_size,
+        result.run_number,
+        result.read_time_ms,
+        result.throughput_mbps,
+        result.iops,
+        cache_mode_name(result.cache_mode),
+        result.threads,
+        result.thread_id,
+        engine_name(result.engine),
+        result.qd,
+        result.variant,
+        access_pattern_name(result.pattern),
+        latency_str,
+        durable_str,
+        result.target,
+        cpu_str,
+        stats_str,
+        verify_str,
+        placement_str(result.cpu_id),
+        placement_str(result.numa_node),
+        buffer_strategy_name(result.buffer),
+        run_phase_name(result.phase),
+        ttfb_str,
+        fuse_str,
+        vq_str
+    );
+}
+
+// Quotes text as a JSON string
+std::string json_string(const std::string& text) {
+    std::string quoted = "\"";
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"':  quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    quoted += std::format("\\u{:04x}", (int)c);
+                } else {
+                    quoted += (char)c;
+                }
+        }
+    }
+    return quoted + "\"";
+}
+
+// One "result" line of the JSON Lines output, with the same fields as a CSV
+// row. Groups of columns that were not measured are null.
+void format_result_json(std::string& out, const struct BenchmarkResult& result, const std::string& timestamp) {
+    std::string latency = "null";
+    if (result.latency.valid) {
+        latency = std::format("{{\"p50\":{:.3f},\"p90\":{:.3f},\"p99\":{:.3f},\"p999\":{:.3f},\"max\":{:.3f}}}",
+                              result.latency.p50_us, result.latency.p90_us, result.latency.p99_us,
+                              result.latency.p999_us, result.latency.max_us);
+    }
+
+    std::string durable = result.durable_time_ms >= 0 ? std::format("{:.3f}", result.durable_time_ms) : "null";
+
+    auto counter = [](long long value) { return value < 0 ? std::string("null") : std::to_string(value); };
+    std::string cpu = "null";
+    if (result.cpu.valid) {
+        cpu = std::format("{{\"user_ms\":{:.3f},\"sys_ms\":{:.3f},\"ns_per_mib\":{},\"vol_ctx_switches\":{},"
+                          "\"invol_ctx_switches\":{},\"cycles\":{},\"instructions\":{},\"page_faults\":{}}}",
+                          result.cpu.user_ms, result.cpu.sys_ms,
+                          result.cpu.ns_per_mib < 0 ? "null" : std::format("{:.0f}", result.cpu.ns_per_mib),
+                          result.cpu.voluntary_switches, result.cpu.involuntary_switches,
+                          counter(result.cpu.cycles), counter(result.cpu.instructions),
+                          counter(result.cpu.page_faults));
+    }
+
+    std::string stats = "null";
+    if (result.stats.valid) {
+        stats = std::format("{{\"ci_low_ms\":{:.3f},\"ci_high_ms\":{:.3f},\"ci_low_mbps\":{:.3f},"
+                            "\"ci_high_mbps\":{:.3f},\"outlier\":{}}}",
+                            result.stats.time_ci_low_ms, result.stats.time_ci_high_ms, result.stats.mbps_ci_low,
+                            result.stats.mbps_ci_high, result.stats.outlier ? "true" : "false");
+    }
+
+    std::string verify = "null";
+    if (result.verify.valid) {
+        verify = std::format("{{\"time_ms\":{:.3f},\"corrupt_reads\":{}}}", result.verify.time_ms,
+                             result.verify.corrupt_reads);
+    }
+
+    std::string fuse = "null";
+    if (result.fuse.valid) {
+        fuse = std::format("{{\"requests\":{},\"reads\":{},\"read_kib\":{}}}", result.fuse.requests,
+                           result.fuse.reads,
+                           result.fuse.read_kib < 0 ? "null" : std::format("{:.1f}", result.fuse.read_kib));
+    }
+
+    std::format_to(std::back_inserter(out),
+        "{{\"record\":\"result\",\"timestamp\":{},\"target\":{},\"engine\":{},\"cache_mode\":{},"
+        "\"pattern\":{},\"variant\":{},\"chunk_size\":{},\"run\":{},\"threads\":{},\"thread_id\":{},"
+        "\"qd\":{},\"read_time_ms\":{:.3f},\"throughput_mbps\":{:.3f},\"iops\":{:.1f},\"latency_us\":{},"
+        "\"durable_time_ms\":{},\"cpu\":{},\"stats\":{},\"verify\":{},\"cpu_id\":{},\"numa_node\":{},\"buffer\":{},"
+        "\"phase\":{},\"ttfb_us\":{},\"fuse\":{},\"vq_irqs_per_mib\":{}}}\n",
+        json_string(timestamp),
+        json_string(result.target),
+        json_string(engine_name(result.engine)),
+        json_string(cache_mode_name(result.cache_mode)),
+        json_string(access_pattern_name(result.pattern)),
+        json_string(result.variant),
+        result.chunk_size,
+        result.run_number,
+        result.threads,
+        result.thread_id,
+        result.qd,
+        result.read_time_ms,
+        result.throughput_mbps,
+        result.iops,
+        latency,
+        durable,
+        cpu,
+        stats,
+        verify,
+        result.cpu_id < 0 ? "null" : std::to_string(result.cpu_id),
+        result.numa_node < 0 ? "null" : std::to_string(result.numa_node),
+        json_string(buffer_strategy_name(result.buffer)),
+        result.phase == RunPhase::None ? "null" : json_string(run_phase_name(result.phase)),
+        result.ttfb_us < 0 ? "null" : std::format("{:.3f}", result.ttfb_us),
+        fuse,
+        result.fuse.vq_irqs_per_mib < 0 ? "null" : std::format("{:.2f}", result.fuse.vq_irqs_per_mib)
+    );
+}
+
+bool write_all(int fd, const std::string& text) {
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = write(fd, text.data() + written, text.size() - written);
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+// Writes the header and all collected rows with as few write(2) calls as
+// possible, once the measurements are over
+bool write_results(int data_fd, const std::vector<BenchmarkResult>& results) {
+    std::string csv = CSV_HEADER;
+    for (const BenchmarkResult& result : results) {
+        format_result(csv, result);
+    }
+    return write_all(data_fd, csv);
+}
+
+#define TIMESERIES_HEADER "target,engine,variant,chunk_size,run_number,threads,buffer,time_ms,bytes,ops," \
+                          "interval_mbps,interval_iops\n"
+
+// With --sample-interval, one line per sample of every reported run. The
+// counters are cumulative, the rates cover the time since the previous
+// sample, so stalls and ramp-ups within a run show up.
+bool write_timeseries(int fd, const std::vector<BenchmarkResult>& results) {
+    std::string csv = TIMESERIES_HEADER;
+    for (const BenchmarkResult& result : results) {
+        ThroughputSample previous = {0, 0, 0};
+        for (const ThroughputSample& sample : result.samples) {
+            double seconds = (sample.time_ms - previous.time_ms) / 1000.0;
+            double mbps = seconds > 0 ? (sample.bytes - previous.bytes) / (1024.0 * 1024.0) / seconds : 0;
+            double iops = seconds > 0 ? (sample.ops - previous.ops) / seconds : 0;
+            std::format_to(std::back_inserter(csv), "{},{},{},{},{},{},{},{:.3f},{},{},{:.3f},{:.1f}\n",
+                result.target,
+                engine_name(result.engine),
+                result.variant,
+                result.chunk_size,
+                result.run_number,
+                result.threads,
+                buffer_strategy_name(result.buffer),
+                sample.time_ms,
+                sample.bytes,
+                sample.ops,
+                mbps,
+                iops
+            );
+            previous = sample;
+        }
+    }
+    return write_all(fd, csv);
+}
+
+// NUMA node of a CPU from its sysfs directory, 0 on kernels without NUMA
+int cpu_numa_node(int cpu) {
+    DIR* directory = opendir(std::format("/sys/devices/system/cpu/cpu{}", cpu).c_str());
+    if (directory == NULL) {
+        return 0;
+    }
+    int node = 0;
+    while (struct dirent* entry = readdir(directory)) {
+        if (std::strncmp(entry->d_name, "node", 4) == 0 && std::isdigit((unsigned char)entry->d_name[4])) {
+            node = std::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(directory);
+    return node;
+}
+
+int worker_cpu(const BenchmarkConfig& config, int worker) {
+    return config.cpus.empty() ? -1 : config.cpus[worker % config.cpus.size()];
+}
+
+int worker_mem_node(const BenchmarkConfig& config, int worker) {
+    if (config.mem_node == MEM_NODE_LOCAL) {
+        return cpu_numa_node(worker_cpu(config, worker));
+    }
+    return config.mem_node;
+}
+
+// Fills in the CPU and node shared by every worker a row covers
+void record_placement(BenchmarkResult& result, const BenchmarkConfig& config) {
+    int first = result.first_worker + std::max(0, result.thread_id);
+    int workers = result.thread_id == AGGREGATE_THREAD_ID ? result.threads : 1;
+    result.cpu_id = worker_cpu(config, first);
+    result.numa_node = worker_mem_node(config, first);
+    for (int worker = first + 1; worker < first + workers; worker++) {
+        if (worker_cpu(config, worker) != result.cpu_id) {
+            result.cpu_id = -1;
+        }
+        if (worker_mem_node(config, worker) != result.numa_node) {
+            result.numa_node = -1;
+        }
+    }
+}
+
+// Stores a finished run. Rows are only written out at the end so the timed
+// loop never waits on the output file or the console.
+void record_result(std::vector<BenchmarkResult>& results, BenchmarkResult&& result, const BenchmarkConfig& config) {
+    if (config.verbosity >= 2) {
+        std::cout << std::format("  {} {} bytes run {}: {:.3f} ms, {:.3f} MB/s\n", engine_name(result.engine),
+                                 result.chunk_size, result.run_number, result.read_time_ms, result.throughput_mbps);
+    }
+    result.target = config.target_name;
+    result.buffer = config.buffer_strategy;
+    result.phase = run_phase(config, result.run_number);
+    record_placement(result, config);
+    results.push_back(std::move(result));
+}
+
+// 95% confidence interval of the median of values (sorted in place). The
+// bounds are the order statistics at ranks n/2 -+ 1.96 sqrt(n)/2; fewer
+// than 6 values give no interval.
+bool median_interval(std::vector<double>& values, double& low, double& high) {
+    size_t n = values.size();
+    if (n < 6) {
+        return false;
+    }
+    std::sort(values.begin(), values.end());
+    double half_width = 1.96 * std::sqrt((double)n) / 2.0;
+    long long lower_rank = std::max(1LL, std::llround(n / 2.0 - half_width));
+    long long upper_rank = std::min((long long)n, std::llround(1 + n / 2.0 + half_width));
+    low = values[lower_rank - 1];
+    high = values[upper_rank - 1];
+    return true;
+}
+
+// Value at fraction of the sorted values, linearly interpolated
+double quantile(const std::vector<double>& sorted, double fraction) {
+    double position = fraction * (sorted.size() - 1);
+    size_t below = (size_t)position;
+    if (below + 1 >= sorted.size()) {
+        return sorted.back();
+    }
+    return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+// Decides how many runs one configuration gets and fills in the
+// RunStatistics of its rows. Without --ci-width and --time-budget every
+// configuration does --warmup + --runs passes. With --ci-width, runs stop
+// after --min-runs once the median read time interval of every series is
+// narrower than ci_width times the median; --runs is then the upper bound.
+// Engines with several series per pass (metadata phases) pass their index.
+struct RunControl {
+    const BenchmarkConfig& config;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    std::vector<std::vector<size_t>> rows; // Indices into results, per series
+    std::vector<std::vector<double>> times; // Read times in ms, per series
+
+    RunControl(const BenchmarkConfig& config, int series = 1) : config(config), rows(series), times(series) {}
+
+    // Called before pass run (warmup passes included)
+    bool more(int run) const {
+        int measured = run - config.warmup;
+        if (measured < 1) {
+            return true;
+        }
+        if (measured >= config.runs) {
+            return false;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        if (config.time_budget > 0 && elapsed.count() >= config.time_budget) {
+            return false;
+        }
+        if (config.ci_width <= 0 || measured < config.min_runs) {
+            return true;
+        }
+        for (std::vector<double> series_times : times) {
+            double low, high;
+            if (!median_interval(series_times, low, high)
+                || high - low > config.ci_width * quantile(series_times, 0.5)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The cold run of --phases is a series of its own and stays out of the
+    // statistics of the warm ones
+    void record(std::vector<BenchmarkResult>& results, BenchmarkResult&& result, int series = 0) {
+        if (!config.phases || result.run_number > 1) {
+            rows[series].push_back(results.size());
+            times[series].push_back(result.read_time_ms);
+        }
+        record_result(results, std::move(result), config);
+    }
+
+    // Annotates the rows of every series once the runs are over
+    void finish(std::vector<BenchmarkResult>& results) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            const std::vector<size_t>& series = rows[i];
+            std::vector<double>& series_times = times[i];
+            std::vector<double> throughputs;
+            for (size_t row : series) {
+                throughputs.push_back(results[row].throughput_mbps);
+            }
+            RunStatistics stats;
+            if (!median_interval(series_times, stats.time_ci_low_ms, stats.time_ci_high_ms)) {
+                if (config.verbosity >= 1 && (config.ci_width > 0 || config.time_budget > 0)) {
+                    std::cout << "  " << series.size() << " runs, too few for a confidence interval\n";
+                }
+                continue;
+            }
+            median_interval(throughputs, stats.mbps_ci_low, stats.mbps_ci_high);
+            stats.valid = true;
+
+            double q1 = quantile(series_times, 0.25);
+            double q3 = quantile(series_times, 0.75);
+            double fence_low = q1 - 1.5 * (q3 - q1);
+            double fence_high = q3 + 1.5 * (q3 - q1);
+            for (size_t row : series) {
+                results[row].stats = stats;
+                results[row].stats.outlier = results[row].read_time_ms < fence_low
+                                             || results[row].read_time_ms > fence_high;
+            }
+
+            if (config.verbosity >= 1 && (config.ci_width > 0 || config.time_budget > 0)) {
+                double median = quantile(series_times, 0.5);
+                std::cout << std::format("  {} runs, median {:.3f} ms, 95% CI {:.3f}..{:.3f} ms (+-{:.1f}%)\n",
+                                         series.size(), median, stats.time_ci_low_ms, stats.time_ci_high_ms,
+                                         50.0 * (stats.time_ci_high_ms - stats.time_ci_low_ms) / median);
+            }
+        }
+    }
+};
+
+// Gives the fadvise hint of the current sweep point. Called after the caches
+// were invalidated, outside the timed region.
+void apply_fadvise_hint(const BenchmarkConfig& config, int test_fd) {
+    int advice;
+    switch (config.tuning.fadvise) {
+        case FadviseHint::None:       return;
+        case FadviseHint::Normal:     advice = POSIX_FADV_NORMAL; break;
+        case FadviseHint::Sequential: advice = POSIX_FADV_SEQUENTIAL; break;
+        case FadviseHint::Random:     advice = POSIX_FADV_RANDOM; break;
+        case FadviseHint::WillNeed:   advice = POSIX_FADV_WILLNEED; break;
+        default:                      return;
+    }
+    int err = posix_fadvise(test_fd, 0, 0, advice);
+    if (err != 0) {
+        std::cerr << "posix_fadvise(" << fadvise_hint_name(config.tuning.fadvise) << ") failed: "
+                  << strerror(err) << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Whether the caches are invalidated before the pass: every one, or with
+// --phases only the first reported (cold) run
+bool invalidates_caches(const BenchmarkConfig& config, int run) {
+    return !config.phases || run == config.warmup;
+}
+
+// Evicts the test file from the caches according to the selected mode.
+// Called before every pass (run counts warmup passes), outside the timed
+// region. test_fd may be -1 when there is no single file to advise on
+// (metadata engine).
+void invalidate_caches(const BenchmarkConfig& config, int test_fd, int run) {
+    if (!invalidates_caches(config, run)) {
+        return;
+    }
+    if (config.cache_mode == CacheMode::Fadvise && test_fd != -1) {
+        int err = posix_fadvise(test_fd, 0, 0, POSIX_FADV_DONTNEED);
+        if (err != 0) {
+            std::cerr << "posix_fadvise(POSIX_FADV_DONTNEED) failed: " << strerror(err) << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    } else if (config.cache_mode == CacheMode::DropCaches) {
+        sync();
+        int drop_fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+        if (drop_fd == -1 || write(drop_fd, "3", 1) != 1) {
+            perror("Could not drop caches (are you root?)");
+            std::exit(EXIT_FAILURE);
+        }
+        close(drop_fd);
+    }
+
+    if (!config.drop_hook.empty()) {
+        int status = std::system(config.drop_hook.c_str());
+        if (status != 0) {
+            std::cerr << "Drop hook \"" << config.drop_hook << "\" failed with status " << status << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void* allocate_chunk_buffer(int chunk_size, bool direct) {
+    void* buffer = NULL;
+    if (direct) {
+        // O_DIRECT needs the user buffer aligned to the logical block size
+        size_t alloc_size = (chunk_size + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+        if (posix_memalign(&buffer, DIRECT_IO_ALIGNMENT, alloc_size) != 0) {
+            buffer = NULL;
+        }
+    } else {
+        buffer = std::malloc(chunk_size);
+    }
+    if (buffer == NULL) {
+        std::cerr << "Could not allocate chunk buffer!\n";
+        exit(1);
+    }
+    return buffer;
+}
+
+// Bitwise-reflected crc32c (Castagnoli) one byte at a time, for CPUs
+// without the SSE4.2 crc32 instruction
+uint32_t crc32c_software(uint32_t crc, const unsigned char* data, size_t size) {
+    static uint32_t table[256];
+    static bool table_ready = false;
+    if (!table_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t entry = i;
+            for (int bit = 0; bit < 8; bit++) {
+                entry = (entry >> 1) ^ (entry & 1 ? 0x82F63B78u : 0);
+            }
+            table[i] = entry;
+        }
+        table_ready = true;
+    }
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+// crc32c with the SSE4.2 instruction, eight bytes per step
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const unsigned char* data, size_t size) {
+    uint64_t state = crc;
+    while (size >= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        state = _mm_crc32_u64(state, word);
+        data += sizeof(word);
+        size -= sizeof(word);
+    }
+    crc = (uint32_t)state;
+    while (size > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        size--;
+    }
+    return crc;
+}
+#endif
+
+uint32_t crc32c(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+#if defined(__x86_64__)
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    if (hardware) {
+        return ~crc32c_sse42(~0u, bytes, size);
+    }
+#endif
+    return ~crc32c_software(~0u, bytes, size);
+}
+
+// Checks the data of every read of a plan. Pattern mode regenerates the
+// expected bytes of --generate; crc32c mode compares against checksums of
+// one untimed buffered pass over the same plan, which catches reads that
+// disagree with the page cache (torn O_DIRECT reads, a misbehaving FUSE
+// server) without knowing what the file holds.
+struct Verifier {
+    VerifyMode mode;
+    FillPattern fill;
+    uint64_t seed;
+    std::vector<uint32_t> checksums; // crc32c of every op of the plan
+    std::vector<unsigned char> expected; // Scratch for regenerated pattern data
+    long long corrupt_reads = 0;
+    off_t first_corrupt = -1;
+
+    Verifier(const BenchmarkConfig& config, const AccessPlan& plan)
+        : mode(config.verify), fill(config.fill), seed(config.seed) {
+        if (mode == VerifyMode::Pattern) {
+            // Room for the word-aligned start before the offset
+            expected.resize(plan.chunk_size + 2 * sizeof(uint64_t));
+        } else if (mode == VerifyMode::Crc32c) {
+            int fd = open(config.target_path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                perror("Could not open test file");
+                std::exit(EXIT_FAILURE);
+            }
+            expected.resize(plan.chunk_size);
+            checksums.resize(plan.ops);
+            for (size_t op = 0; op < plan.ops; op++) {
+                size_t length = plan.length(op);
+                if (pread(fd, expected.data(), length, plan.offset(op)) != (ssize_t)length) {
+                    std::cerr << "Could not read reference checksums of the test file\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                checksums[op] = crc32c(expected.data(), length);
+            }
+            close(fd);
+        }
+    }
+
+    bool enabled() const {
+        return mode != VerifyMode::None;
+    }
+
+    // Checks size bytes read by op of the plan from offset
+    bool check(size_t op, off_t offset, const void* data, size_t size) {
+        bool good;
+        if (mode == VerifyMode::Pattern) {
+            off_t skew = offset % sizeof(uint64_t);
+            fill_pattern(expected.data(), size + skew, offset - skew, fill, seed);
+            good = std::memcmp(expected.data() + skew, data, size) == 0;
+        } else {
+            good = op < checksums.size() && crc32c(data, size) == checksums[op];
+        }
+        if (!good) {
+            if (corrupt_reads == 0) {
+                first_corrupt = offset;
+            }
+            corrupt_reads++;
+        }
+        return good;
+    }
+
+    // Reports the corrupt reads of one pass and starts the next
+    VerifyResult finish(double time_ms) {
+        VerifyResult result = {true, time_ms, corrupt_reads};
+        if (corrupt_reads > 0) {
+            std::cerr << corrupt_reads << " reads did not match (" << verify_mode_name(mode)
+                      << "), first at offset " << first_corrupt << "\n";
+        }
+        corrupt_reads = 0;
+        first_corrupt = -1;
+        return result;
+    }
+};
+
+// Pins thread to the --cpus entry of worker, a no-op without --cpus
+void pin_worker(const BenchmarkConfig& config, pthread_t thread, int worker) {
+    if (config.cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker_cpu(config, worker), &set);
+    int error = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (error != 0) {
+        std::cerr << "Could not pin worker " << worker << " to CPU " << worker_cpu(config, worker) << ": "
+                  << strerror(error) << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Buffers that were mapped instead of malloc'ed, and therefore need munmap
+std::vector<std::pair<void*, size_t>> mapped_buffers;
+
+// Reusable arena: one reservation, faulted in up to high_water once and
+// handed out again for every later chunk size
+struct BufferArena {
+    char* base = NULL;
+    size_t used = 0;
+    size_t high_water = 0;
+    int live = 0; // Handed out and not yet freed; the arena restarts at 0 when none are
+} buffer_arena;
+
+// A chunk buffer of worker, allocated with the --buffers strategy. With
+// --mem-node the pages are bound to the node with mbind (raw syscall, no
+// libnuma) before they are faulted in. Every strategy but malloc faults
+// the buffer in here, before any timing.
+void* allocate_worker_buffer(const BenchmarkConfig& config, size_t size, bool direct, int worker) {
+    BufferStrategy strategy = config.buffer_strategy;
+    if (strategy == BufferStrategy::Malloc && config.mem_node == MEM_NODE_NONE) {
+        return allocate_chunk_buffer((int)size, direct);
+    }
+    bool huge = strategy == BufferStrategy::Thp || strategy == BufferStrategy::Hugetlb;
+    size_t alignment = huge ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+    size_t length = (size + alignment - 1) / alignment * alignment;
+
+    void* buffer = NULL;
+    switch (strategy) {
+        case BufferStrategy::Malloc:
+        case BufferStrategy::Thp:
+            if (posix_memalign(&buffer, alignment, length) != 0) {
+                buffer = NULL;
+            } else if (strategy == BufferStrategy::Thp) {
+                madvise(buffer, length, MADV_HUGEPAGE);
+            }
+            break;
+        case BufferStrategy::Populate:
+        case BufferStrategy::Hugetlb: {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+            if (strategy == BufferStrategy::Hugetlb) {
+                flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT); // 2 MiB pages
+            } else if (config.mem_node == MEM_NODE_NONE) {
+                flags |= MAP_POPULATE;
+            }
+            buffer = mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (buffer == MAP_FAILED) {
+                std::cerr << "Could not map a " << length << " byte " << buffer_strategy_name(strategy)
+                          << " buffer: " << strerror(errno)
+                          << (strategy == BufferStrategy::Hugetlb ? " (reserve pages in /proc/sys/vm/nr_hugepages)" : "")
+                          << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+            mapped_buffers.emplace_back(buffer, length);
+            break;
+        }
+        case BufferStrategy::Arena:
+            if (buffer_arena.base == NULL) {
+                buffer_arena.base = (char*)mmap(NULL, ARENA_RESERVE, PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                if (buffer_arena.base == MAP_FAILED) {
+                    perror("Could not reserve buffer arena");
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+            if (buffer_arena.live == 0) {
+                buffer_arena.used = 0;
+            }
+            if (buffer_arena.used + length > ARENA_RESERVE) {
+                std::cerr << "Buffer arena of " << ARENA_RESERVE << " bytes exhausted\n";
+                std::exit(EXIT_FAILURE);
+            }
+            buffer = buffer_arena.base + buffer_arena.used;
+            buffer_arena.used += length;
+            buffer_arena.live++;
+            break;
+    }
+    if (buffer == NULL) {
+        std::cerr << "Could not allocate chunk buffer!\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (config.mem_node != MEM_NODE_NONE) {
+        int node = worker_mem_node(config, worker);
+        unsigned long mask[16] = {};
+        if (node < 0 || node >= (int)(sizeof(mask) * 8)) {
+            std::cerr << "NUMA node " << node << " out of range\n";
+            std::exit(EXIT_FAILURE);
+        }
+        mask[node / (sizeof(unsigned long) * 8)] |= 1ul << (node % (sizeof(unsigned long) * 8));
+        if (syscall(SYS_mbind, buffer, length, MPOL_BIND, mask, sizeof(mask) * 8,
+                    MPOL_MF_MOVE | MPOL_MF_STRICT) == -1) {
+            std::cerr << "Could not bind buffer to NUMA node " << node << ": " << strerror(errno) << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Arena pages below the high water mark are already in
+    if (strategy == BufferStrategy::Arena) {
+        char* end = (char*)buffer + length;
+        char* faulted = buffer_arena.base + buffer_arena.high_water;
+        if (end > faulted) {
+            std::memset(std::max((char*)buffer, faulted), 0, end - std::max((char*)buffer, faulted));
+            buffer_arena.high_water = end - buffer_arena.base;
+        }
+    } else {
+        std::memset(buffer, 0, length);
+    }
+    return buffer;
+}
+
+void free_worker_buffer(void* buffer) {
+    if (buffer_arena.base != NULL && (char*)buffer >= buffer_arena.base
+        && (char*)buffer < buffer_arena.base + ARENA_RESERVE) {
+        buffer_arena.live--;
+        return;
+    }
+    for (size_t i = 0; i < mapped_buffers.size(); i++) {
+        if (mapped_buffers[i].first == buffer) {
+            munmap(buffer, mapped_buffers[i].second);
+            mapped_buffers.erase(mapped_buffers.begin() + i);
+            return;
+        }
+    }
+    std::free(buffer);
+}
+
+std::string thread_file_path(const BenchmarkConfig& config, int thread_id) {
+    if (config.thread_layout == ThreadLayout::File) {
+        return std::format("{}.{}", config.target_path, thread_id);
+    }
+    return config.target_path;
+}
+
+// Copies the first size bytes of source to destination unless destination
+// already has exactly that size
+void copy_test_file(const std::string& source, const std::string& destination, long long size) {
+    struct stat st;
+    if (stat(destination.c_str(), &st) == 0 && st.st_size == size) {
+        return;
+    }
+
+    std::vector<char> copy_buffer(1024 * 1024);
+    int src_fd = open(source.c_str(), O_RDONLY);
+    int dst_fd = open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (src_fd == -1 || dst_fd == -1) {
+        perror(("Could not create test file " + destination).c_str());
+        std::exit(EXIT_FAILURE);
+    }
+    long long copied = 0;
+    while (copied < size) {
+        size_t to_copy = std::min<long long>(copy_buffer.size(), size - copied);
+        ssize_t n = read(src_fd, copy_buffer.data(), to_copy);
+        if (n <= 0 || write(dst_fd, copy_buffer.data(), n) != n) {
+            perror(("Could not write test file " + destination).c_str());
+            std::exit(EXIT_FAILURE);
+        }
+        copied += n;
+    }
+    close(src_fd);
+    if (close(dst_fd) == -1) {
+        perror(("Could not close test file " + destination).c_str());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Creates the per-thread copies of the test file used by ThreadLayout::File.
+// Existing copies of the right size are reused.
+void prepare_thread_files(const BenchmarkConfig& config) {
+    if (config.thread_layout != ThreadLayout::File) {
+        return;
+    }
+
+    for (int thread_id = 0; thread_id < config.threads; thread_id++) {
+        copy_test_file(config.target_path, thread_file_path(config, thread_id), config.file_size);
+    }
+}
+
+struct ThreadTiming {
+    std::chrono::high_resolution_clock::time_point start;
+    std::chrono::high_resolution_clock::time_point end;
+    std::chrono::high_resolution_clock::time_point first_byte;
+    long long total_read;
+    long long expected;
+    size_t ops;
+    bool rejected; // O_DIRECT transfer rejected by the filesystem
+    LatencyHistogram latency;
+};
+
+// Reads every offset of the plan from fd with pread
+void parallel_reader(int fd, void* buffer, const AccessPlan& plan, bool track_latency,
+                     long long prefetch_window, std::barrier<>& start_line, ThreadTiming& timing,
+                     ProgressCounter* progress) {
+    start_line.arrive_and_wait();
+    timing.start = std::chrono::high_resolution_clock::now();
+
+    long long total_read = 0;
+    ssize_t bytes_read = 0;
+    size_t op = 0;
+    off_t prefetched = plan.region_start;
+    uint64_t last_ns = track_latency ? now_ns() : 0;
+    for (; op < plan.ops; op++) {
+        if (prefetch_window > 0 && plan.offset(op) + prefetch_window > prefetched) {
+            readahead(fd, prefetched, prefetch_window);
+            prefetched += prefetch_window;
+            // Issuing the prefetch is not part of the next read's latency
+            if (track_latency) last_ns = now_ns();
+        }
+        bytes_read = pread(fd, buffer, plan.length(op), plan.offset(op));
+        if (track_latency) {
+            uint64_t done_ns = now_ns();
+            timing.latency.record(done_ns - last_ns);
+            last_ns = done_ns;
+        }
+        if (bytes_read <= 0) break;
+        if (total_read == 0) timing.first_byte = std::chrono::high_resolution_clock::now();
+        total_read += bytes_read;
+        if (progress) progress->add(bytes_read);
+    }
+
+    timing.end = std::chrono::high_resolution_clock::now();
+    timing.total_read = total_read;
+    timing.expected = plan.bytes;
+    timing.ops = op;
+    timing.rejected = bytes_read == -1 && errno == EINVAL;
+}
+
+void benchmark_chunk_size_parallel(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    bool direct = config.cache_mode == CacheMode::Direct;
+    int threads = config.threads;
+    bool per_thread_file = config.thread_layout == ThreadLayout::File;
+
+    std::vector<void*> buffers(threads);
+    for (int i = 0; i < threads; i++) {
+        buffers[i] = allocate_worker_buffer(config, chunk_size, direct, i);
+    }
+
+    auto aggregate_latency = std::make_unique<LatencyHistogram>();
+
+    // Slice layout splits one file, the last thread picks up the remainder
+    long long slice = config.file_size / threads;
+    std::vector<AccessPlan> plans;
+    long long total_bytes = 0;
+    size_t total_ops = 0;
+    for (int i = 0; i < threads; i++) {
+        long long offset = per_thread_file ? 0 : slice * i;
+        long long length = per_thread_file ? config.file_size
+                         : (i == threads - 1 ? config.file_size - slice * i : slice);
+        plans.push_back(plan_accesses(config, chunk_size, offset, length, config.seed + i));
+        total_bytes += plans.back().bytes;
+        total_ops += plans.back().ops;
+    }
+    std::string variant = read_tuning_name(config.tuning);
+
+    CpuMeter meter(config.perf);
+    FuseTracer tracer(config, config.target_path);
+    ThroughputSampler sampler(config, threads);
+
+    RunControl control(config);
+    for (int run = 0; control.more(run); run++) {
+        // Open one descriptor per thread so no file position or lock is shared
+        std::vector<int> fds(threads);
+        for (int i = 0; i < threads; i++) {
+            std::string path = thread_file_path(config, i);
+            fds[i] = open(path.c_str(), direct ? O_RDONLY | O_DIRECT : O_RDONLY);
+            if (fds[i] == -1) {
+                perror("Could not open test file");
+                std::exit(EXIT_FAILURE);
+            }
+            if (per_thread_file || i == 0) {
+                invalidate_caches(config, fds[i], run);
+            }
+            apply_fadvise_hint(config, fds[i]);
+        }
+
+        std::vector<ThreadTiming> timings(threads);
+        std::vector<std::thread> workers;
+        std::barrier start_line(threads + 1);
+        ProgressCounter* progress = sampler.start();
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(parallel_reader, fds[i], buffers[i], std::cref(plans[i]), config.latency,
+                                 config.tuning.prefetch_window, std::ref(start_line), std::ref(timings[i]),
+                                 progress ? progress + i : NULL);
+            pin_worker(config, workers.back().native_handle(), i);
+        }
+
+        tracer.start();
+        meter.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        start_line.arrive_and_wait();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        CpuUsage cpu = meter.stop(total_bytes);
+        std::vector<ThroughputSample> samples = sampler.stop();
+        FuseTrace fuse = tracer.stop(total_bytes);
+        auto end = start;
+        auto first_byte = timings[0].first_byte;
+        for (const ThreadTiming& timing : timings) {
+            end = std::max(end, timing.end);
+            first_byte = std::min(first_byte, timing.first_byte);
+        }
+
+        for (int fd : fds) {
+            if (close(fd) == -1) {
+                std::cerr << "Error closing test file\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        bool rejected = false;
+        for (const ThreadTiming& timing : timings) {
+            rejected |= direct && timing.rejected;
+            if (!rejected && timing.total_read != timing.expected) {
+                std::cerr << "Could not read entire file!\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        if (rejected) {
+            std::cerr << "O_DIRECT read of " << chunk_size << " bytes rejected, skipping chunk size\n";
+            break;
+        }
+
+        // Warmup passes are not reported
+        if (run < config.warmup) {
+            continue;
+        }
+
+        // Per-thread rows cover only that thread's share of the data
+        LatencyHistogram& run_latency = *aggregate_latency;
+        run_latency.reset();
+        for (int i = 0; i < threads; i++) {
+            std::chrono::duration<double> thread_diff = timings[i].end - timings[i].start;
+            double thread_mbps = (timings[i].total_read / (1024.0 * 1024.0)) / thread_diff.count();
+            double thread_iops = timings[i].ops / thread_diff.count();
+            struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, thread_diff.count() * 1000.0, thread_mbps,
+                                             thread_iops, config.cache_mode, threads, i, Engine::Sync, 1,
+                                             variant, config.pattern, timings[i].latency.summary()};
+            std::chrono::duration<double, std::micro> thread_ttfb = timings[i].first_byte - timings[i].start;
+            result.ttfb_us = thread_ttfb.count();
+            record_result(results, std::move(result), config);
+            run_latency.merge(timings[i].latency);
+        }
+
+        std::chrono::duration<double> start_stop_diff = end - start;
+        double read_time_ms = start_stop_diff.count() * 1000.0;
+        double throughput_mbps = (total_bytes / (1024.0 * 1024.0)) / start_stop_diff.count();
+        double iops = total_ops / start_stop_diff.count();
+        struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, read_time_ms, throughput_mbps,
+                                         iops, config.cache_mode, threads, AGGREGATE_THREAD_ID, Engine::Sync, 1,
+                                         variant, config.pattern, run_latency.summary()};
+        result.cpu = cpu;
+        result.fuse = fuse;
+        result.samples = std::move(samples);
+        result.ttfb_us = std::chrono::duration<double, std::micro>(first_byte - start).count();
+        control.record(results, std::move(result));
+    }
+    control.finish(results);
+
+    for (void* buffer : buffers) {
+        free_worker_buffer(buffer);
+    }
+}
+
+// Progress of one timed pass of a read engine
+struct ReadTally {
+    long long bytes = 0;
+    size_t ops = 0;
+    std::chrono::high_resolution_clock::time_point first_byte;
+    ProgressCounter* progress = NULL; // --sample-interval counter, NULL when sampling is off
+
+    void add(ssize_t done) {
+        if (bytes == 0) {
+            first_byte = std::chrono::high_resolution_clock::now();
+        }
+        bytes += done;
+        ops++;
+        if (progress) progress->add(done);
+    }
+};
+
+// Shared harness of the single-threaded read engines. It opens the test
+// file, invalidates the caches, times and samples every pass, validates it
+// and records the rows; the access method itself is a backend with:
+//
+//   Engine engine; int qd; std::string variant;  what its rows record
+//   AccessPlan plan;                             set up by prepare
+//   bool prepare(int chunk_size)                 once per chunk size, false skips it (nothing to tear down)
+//   void begin_pass(int fd)                      untimed, after the caches were invalidated: per-pass
+//                                                resources such as a copy destination
+//   int run(int fd, ReadTally& tally, LatencyHistogram* latency)
+//                                                one timed pass: 0, or the errno it stopped at
+//   bool unsupported(int err)                    err means the method is not available here (and was reported)
+//   void after_pass(int fd, bool complete)       untimed work while the file is still open, and the
+//                                                release of what begin_pass or run set up (a mapping)
+//   void annotate(BenchmarkResult& result)       extra fields of a reported row
+//   void teardown()                              after the last pass
+//
+// The harness is instantiated per backend, so run() and the ReadTally
+// updates in its loop are inlined rather than called through a pointer.
+template <typename Backend>
+void run_read_engine(int chunk_size, Backend& backend, std::vector<BenchmarkResult>& results,
+                     const BenchmarkConfig& config) {
+    if (!backend.prepare(chunk_size)) {
+        return;
+    }
+    const AccessPlan& plan = backend.plan;
+    bool direct = config.cache_mode == CacheMode::Direct;
+    auto histogram = std::make_unique<LatencyHistogram>();
+    LatencyHistogram* latency = config.latency ? histogram.get() : NULL;
+
+    CpuMeter meter(config.perf);
+    FuseTracer tracer(config, config.target_path);
+    ThroughputSampler sampler(config);
+    RunControl control(config);
+    for (int run = 0; control.more(run); run++) {
+        int test_fd = open(config.target_path.c_str(), direct ? O_RDONLY | O_DIRECT : O_RDONLY);
+        if (test_fd == -1) {
+            perror("Could not open test file");
+            std::exit(EXIT_FAILURE);
+        }
+
+        invalidate_caches(config, test_fd, run);
+        apply_fadvise_hint(config, test_fd);
+        backend.begin_pass(test_fd);
+        histogram->reset();
+
+        ReadTally tally;
+        tally.progress = sampler.start();
+        tracer.start();
+        meter.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        int err = backend.run(test_fd, tally, latency);
+        auto end = std::chrono::high_resolution_clock::now();
+        CpuUsage cpu = meter.stop(plan.bytes);
+        std::vector<ThroughputSample> samples = sampler.stop();
+        FuseTrace fuse = tracer.stop(plan.bytes);
+        std::chrono::duration<double> start_stop_diff = end - start;
+
+        backend.after_pass(test_fd, err == 0 && tally.bytes == plan.bytes);
+        if (close(test_fd) == -1) {
+            std::cerr << "Error closing test file\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (err == EINVAL && direct) {
+            // The filesystem rejected an unaligned O_DIRECT transfer
+            std::cerr << "O_DIRECT read of " << chunk_size << " bytes rejected, skipping chunk size\n";
+            break;
+        }
+        if (err != 0 && backend.unsupported(err)) {
+            break;
+        }
+        if (err != 0) {
+            std::cerr << engine_name(backend.engine) << " read failed: " << strerror(err) << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+        if (tally.bytes != plan.bytes) {
+            std::cerr << "Could not read entire file!\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Warmup passes are not reported
+        if (run < config.warmup) {
+            continue;
+        }
+
+        double read_time_ms = start_stop_diff.count() * 1000.0;
+        double throughput_mbps = (plan.bytes / (1024.0 * 1024.0)) / start_stop_diff.count();
+        double iops = tally.ops / start_stop_diff.count();
+
+        struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, read_time_ms, throughput_mbps,
+                                         iops, config.cache_mode, 1, AGGREGATE_THREAD_ID, backend.engine,
+                                         backend.qd, backend.variant, config.pattern, histogram->summary()};
+        result.cpu = cpu;
+        result.fuse = fuse;
+        result.samples = std::move(samples);
+        result.ttfb_us = std::chrono::duration<double, std::micro>(tally.first_byte - start).count();
+        backend.annotate(result);
+        control.record(results, std::move(result));
+    }
+    control.finish(results);
+
+    backend.teardown();
+}
+
+// Registry entry for a backend without a sweep of its own
+template <typename Backend>
+void benchmark_chunk_size_with(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    Backend backend(config);
+    run_read_engine(chunk_size, backend, results, config);
+}
+
+// Minimal io_uring wrapper on top of the raw system calls, so the benchmark
+// still builds with nothing but g++ (no liburing)
+struct IoUring {
+    int ring_fd = -1;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* sq_ring;
+    void* cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+};
+
+int io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+int io_uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+bool io_uring_init(IoUring& ring, unsigned entries) {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring.ring_fd = io_uring_setup(entries, &params);
+    if (ring.ring_fd == -1) {
+        return false;
+    }
+
+    ring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring.sq_ring = mmap(NULL, ring.sq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring.ring_fd, IORING_OFF_SQ_RING);
+    ring.cq_ring = mmap(NULL, ring.cq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring.ring_fd, IORING_OFF_CQ_RING);
+    ring.sqes = (struct io_uring_sqe*)mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE, ring.ring_fd, IORING_OFF_SQES);
+    if (ring.sq_ring == MAP_FAILED || ring.cq_ring == MAP_FAILED || ring.sqes == MAP_FAILED) {
+        return false;
+    }
+
+    char* sq = (char*)ring.sq_ring;
+    ring.sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring.sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring.sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring.sq_array = (unsigned*)(sq + params.sq_off.array);
+
+    char* cq = (char*)ring.cq_ring;
+    ring.cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring.cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring.cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+}
+
+void io_uring_destroy(IoUring& ring) {
+    munmap(ring.sqes, ring.sqes_size);
+    munmap(ring.cq_ring, ring.cq_ring_size);
+    munmap(ring.sq_ring, ring.sq_ring_size);
+    close(ring.ring_fd);
+}
+
+// Queues a READ_FIXED of registered buffer buf_index against fixed file 0
+void io_uring_queue_read(IoUring& ring, int buf_index, void* buffer, unsigned length, off_t offset) {
+    unsigned tail = *ring.sq_tail;
+    unsigned index = tail & *ring.sq_mask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->flags = IOSQE_FIXED_FILE;
+    sqe->fd = 0;
+    sqe->addr = (unsigned long)buffer;
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->buf_index = buf_index;
+    sqe->user_data = buf_index;
+    ring.sq_array[index] = index;
+    __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Keeps qd reads in flight on one ring, each slot owning one registered
+// buffer
+struct IoUringBackend {
+    const BenchmarkConfig& config;
+    Engine engine = Engine::IoUring;
+    int qd;
+    std::string variant;
+    AccessPlan plan;
+    IoUring ring;
+    std::vector<struct iovec> iovecs;
+    std::vector<uint64_t> submit_ns;
+    int inflight = 0;
+
+    IoUringBackend(const BenchmarkConfig& config, int qd) : config(config), qd(qd) {}
+
+    bool prepare(int chunk_size) {
+        if (!io_uring_init(ring, qd)) {
+            perror("Could not set up io_uring");
+            std::exit(EXIT_FAILURE);
+        }
+
+        iovecs.resize(qd);
+        for (int i = 0; i < qd; i++) {
+            iovecs[i].iov_base = allocate_worker_buffer(config, chunk_size, true, 0);
+            iovecs[i].iov_len = chunk_size;
+        }
+        if (io_uring_register(ring.ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(), qd) == -1) {
+            perror("Could not register io_uring buffers (RLIMIT_MEMLOCK too low?)");
+            std::exit(EXIT_FAILURE);
+        }
+
+        plan = plan_accesses(config, chunk_size, 0, config.file_size, config.seed);
+        // Latency of a request is submission to being reaped from the CQ ring
+        submit_ns.resize(qd);
+        return true;
+    }
+
+    void begin_pass(int) {}
+
+    int run(int fd, ReadTally& tally, LatencyHistogram* latency) {
+        if (io_uring_register(ring.ring_fd, IORING_REGISTER_FILES, &fd, 1) == -1) {
+            perror("Could not register test file with io_uring");
+            std::exit(EXIT_FAILURE);
+        }
+
+        size_t next_op = 0;
+        int failed_res = 0;
+        std::vector<int> free_slots;
+        for (int i = qd - 1; i >= 0; i--) {
+            free_slots.push_back(i);
+        }
+
+        while (failed_res == 0 && (next_op < plan.ops || inflight > 0)) {
+            unsigned to_submit = 0;
+            while (!free_slots.empty() && next_op < plan.ops) {
+                int slot = free_slots.back();
+                free_slots.pop_back();
+                io_uring_queue_read(ring, slot, iovecs[slot].iov_base, plan.length(next_op), plan.offset(next_op));
+                if (latency) {
+                    submit_ns[slot] = now_ns();
+                }
+                next_op++;
+                to_submit++;
+            }
+            inflight += to_submit;
+
+            if (io_uring_enter(ring.ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS) == -1) {
+                perror("io_uring_enter failed");
+                std::exit(EXIT_FAILURE);
+            }
+
+            unsigned head = *ring.cq_head;
+            unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+            uint64_t reaped_ns = latency ? now_ns() : 0;
+            for (; head != tail; head++) {
+                struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+                if (latency) {
+                    latency->record(reaped_ns - submit_ns[cqe->user_data]);
+                }
+                if (cqe->res < 0 && failed_res == 0) {
+                    failed_res = cqe->res;
+                } else if (cqe->res > 0) {
+                    tally.add(cqe->res);
+                }
+                free_slots.push_back((int)cqe->user_data);
+                inflight--;
+            }
+            __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+        }
+
+        // Short reads are not resubmitted, the harness fails the pass on them
+        return -failed_res;
+    }
+
+    bool unsupported(int) { return false; }
+
+    void after_pass(int, bool) {
+        // Drain requests still in flight after a failure before reusing the ring
+        while (inflight > 0) {
+            io_uring_enter(ring.ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            unsigned head = *ring.cq_head;
+            unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+            inflight -= tail - head;
+            __atomic_store_n(ring.cq_head, tail, __ATOMIC_RELEASE);
+        }
+        io_uring_register(ring.ring_fd, IORING_UNREGISTER_FILES, NULL, 0);
+    }
+
+    void annotate(BenchmarkResult&) {}
+
+    void teardown() {
+        io_uring_register(ring.ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+        io_uring_destroy(ring);
+        for (struct iovec& iov : iovecs) {
+            free_worker_buffer(iov.iov_base);
+        }
+    }
+};
+
+void benchmark_chunk_size_io_uring(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    for (int qd : config.queue_depths) {
+        IoUringBackend backend(config, qd);
+        run_read_engine(chunk_size, backend, results, config);
+    }
+}
+
+volatile uint64_t mmap_checksum_sink;
+
+// Maps the whole test file and touches or checksums every page. The mapping
+// is the DAX window under dax=always, so there is no chunk size to sweep;
+// rows report the page size as their chunk size. The pass goes through the
+// file in VERIFY_SPAN_SIZE spans, the unit of verification and progress.
+struct MmapBackend {
+    const BenchmarkConfig& config;
+    Engine engine = Engine::Mmap;
+    int qd = 1;
+    std::string variant;
+    AccessPlan plan;
+    long page_size = sysconf(_SC_PAGESIZE);
+    void* mapping = NULL;
+    uint64_t checksum = 0;
+    std::unique_ptr<Verifier> verifier;
+    bool verify_inline = false;
+    uint64_t verify_ns = 0;
+    VerifyResult verified;
+
+    MmapBackend(const BenchmarkConfig& config)
+        : config(config), variant(std::format("{}/{}/{}", mmap_fault_name(config.mmap_fault),
+                                              mmap_advice_name(config.mmap_advice),
+                                              mmap_access_name(config.mmap_access))) {}
+
+    bool prepare(int) {
+        BenchmarkConfig span_config = config;
+        span_config.pattern = AccessPattern::Sequential;
+        plan = plan_accesses(span_config, VERIFY_SPAN_SIZE, 0, config.file_size, config.seed);
+        verifier = std::make_unique<Verifier>(config, plan);
+        verify_inline = verifier->enabled() && config.verify_pass == VerifyPass::Inline;
+        return true;
+    }
+
+    void begin_pass(int fd) {
+        if (config.mmap_fault == MmapFault::Cold) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+    }
+
+    // Setting up the mapping is part of the pass
+    int run(int fd, ReadTally& tally, LatencyHistogram*) {
+        int flags = MAP_SHARED;
+        if (config.mmap_fault == MmapFault::Populate) {
+            flags |= MAP_POPULATE;
+        }
+        mapping = mmap(NULL, config.file_size, PROT_READ, flags, fd, 0);
+        if (mapping == MAP_FAILED) {
+            perror("Could not map test file");
+            std::exit(EXIT_FAILURE);
+        }
+        if (config.mmap_advice == MmapAdvice::Sequential) {
+            madvise(mapping, config.file_size, MADV_SEQUENTIAL);
+        } else if (config.mmap_advice == MmapAdvice::Hugepage) {
+            madvise(mapping, config.file_size, MADV_HUGEPAGE);
+        }
+
+        verify_ns = 0;
+        uint64_t verify_start = verify_inline ? now_ns() : 0;
+        for (size_t span = 0; span < plan.ops; span++) {
+            const char* data = (const char*)mapping + plan.offset(span);
+            size_t length = plan.length(span);
+            if (verify_inline) {
+                // The check reads every byte, so it is the access of the pass
+                verifier->check(span, plan.offset(span), data, length);
+            } else if (config.mmap_access == MmapAccess::Touch) {
+                const volatile unsigned char* bytes = (const volatile unsigned char*)data;
+                for (size_t offset = 0; offset < length; offset += page_size) {
+                    checksum += bytes[offset];
+                }
+            } else {
+                const uint64_t* words = (const uint64_t*)data;
+                for (size_t i = 0; i < length / sizeof(uint64_t); i++) {
+                    checksum += words[i];
+                }
+            }
+            tally.add(length);
+        }
+        if (verify_inline) {
+            verify_ns = now_ns() - verify_start;
+        }
+        return 0;
+    }
+
+    bool unsupported(int) { return false; }
+
+    void after_pass(int, bool complete) {
+        if (verifier->enabled() && !verify_inline && complete) {
+            uint64_t verify_start = now_ns();
+            for (size_t span = 0; span < plan.ops; span++) {
+                verifier->check(span, plan.offset(span), (const char*)mapping + plan.offset(span),
+                                plan.length(span));
+            }
+            verify_ns = now_ns() - verify_start;
+        }
+        verified = verifier->finish(verify_ns / 1e6);
+        if (munmap(mapping, config.file_size) == -1) {
+            std::cerr << "Error unmapping test file\n";
+            std::exit(EXIT_FAILURE);
+        }
+        mapping = NULL;
+    }
+
+    void annotate(BenchmarkResult& result) {
+        result.iops = 0; // Spans are not I/O operations, the page faults are in the cpu columns
+        if (verifier->enabled()) {
+            result.verify = verified;
+        }
+    }
+
+    void teardown() {
+        // Keeps the accesses from being optimized away
+        mmap_checksum_sink = checksum;
+    }
+};
+
+void benchmark_mmap(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    if (config.verbosity >= 1) {
+        std::cout << "Testing mmap reads of the whole file\n";
+    }
+    MmapBackend backend(config);
+    run_read_engine((int)backend.page_size, backend, results, config);
+}
+
+// Fills a write buffer with the same (i * 73 + 17) pattern as the test file
+void fill_write_buffer(void* buffer, int chunk_size) {
+    unsigned char* bytes = (unsigned char*)buffer;
+    for (int i = 0; i < chunk_size; i++) {
+        bytes[i] = (i * 73 + 17) & 0xFF;
+    }
+}
+
+// Writes size bytes of generated data to path with large aligned pwrites.
+// The extents are allocated up front where the filesystem supports it, and
+// with several threads every thread writes every threads-th block.
+void generate_file(const std::string& path, long long size, FillPattern fill, int threads, uint64_t seed) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror(("Could not create " + path).c_str());
+        std::exit(EXIT_FAILURE);
+    }
+    // Not posix_fallocate, whose fallback writes the whole file once more
+    fallocate(fd, 0, 0, size);
+
+    long long blocks = (size + GENERATE_BLOCK_SIZE - 1) / GENERATE_BLOCK_SIZE;
+    threads = (int)std::max(1LL, std::min<long long>(threads, blocks));
+    std::vector<int> errors(threads, 0);
+    auto writer = [&](int t) {
+        void* buffer = allocate_chunk_buffer(GENERATE_BLOCK_SIZE, true);
+        for (long long block = t; block < blocks && errors[t] == 0; block += threads) {
+            long long offset = block * GENERATE_BLOCK_SIZE;
+            size_t length = (size_t)std::min<long long>(GENERATE_BLOCK_SIZE, size - offset);
+            fill_pattern(buffer, length, offset, fill, seed);
+            for (size_t written = 0; written < length;) {
+                ssize_t n = pwrite(fd, (char*)buffer + written, length - written, offset + written);
+                if (n <= 0) {
+                    errors[t] = n == 0 ? EIO : errno;
+                    break;
+                }
+                written += n;
+            }
+        }
+        std::free(buffer);
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(writer, t);
+    }
+    writer(0);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    for (int error : errors) {
+        if (error != 0) {
+            std::cerr << "Could not write " << path << ": " << strerror(error) << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    if (close(fd) == -1) {
+        perror(("Error closing " + path).c_str());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Phases of one metadata run, in execution order
+enum class MetadataPhase {
+    Create,        // open(O_CREAT) + write + close of every file
+    Stat,          // stat of every file
+    OpenReadClose, // open + read + close of every file
+    Readdir,       // open + getdents64 until the end + close of every directory
+    Unlink         // unlink of every file
+};
+
+const char* metadata_phase_name(MetadataPhase phase) {
+    switch (phase) {
+        case MetadataPhase::Create:        return "create";
+        case MetadataPhase::Stat:          return "stat";
+        case MetadataPhase::OpenReadClose: return "open_read_close";
+        case MetadataPhase::Readdir:       return "readdir";
+        case MetadataPhase::Unlink:        return "unlink";
+    }
+    return "unknown";
+}
+
+struct MetadataWorker {
+    LatencyHistogram latency;
+    long long bytes = 0;
+    int error = 0; // errno of the failed operation, 0 when all succeeded
+};
+
+// Runs one operation of the phase on item (a file or, for readdir, a directory)
+bool metadata_operation(MetadataPhase phase, const char* path, void* buffer, size_t file_size, long long& bytes) {
+    switch (phase) {
+        case MetadataPhase::Create: {
+            int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd == -1 || write(fd, buffer, file_size) != (ssize_t)file_size) {
+                return false;
+            }
+            bytes += file_size;
+            return close(fd) == 0;
+        }
+        case MetadataPhase::Stat: {
+            struct stat st;
+            return stat(path, &st) == 0;
+        }
+        case MetadataPhase::OpenReadClose: {
+            int fd = open(path, O_RDONLY);
+            if (fd == -1) {
+                return false;
+            }
+            ssize_t n = read(fd, buffer, file_size);
+            if (n < 0) {
+                return false;
+            }
+            bytes += n;
+            return close(fd) == 0;
+        }
+        case MetadataPhase::Readdir: {
+            int fd = open(path, O_RDONLY | O_DIRECTORY);
+            if (fd == -1) {
+                return false;
+            }
+            long n;
+            while ((n = syscall(SYS_getdents64, fd, buffer, file_size)) > 0) {
+                bytes += n;
+            }
+            close(fd);
+            return n == 0;
+        }
+        case MetadataPhase::Unlink:
+            return unlink(path) == 0;
+    }
+    return false;
+}
+
+// Creates a tree of meta_dirs directories holding meta_files small files
+// and times every phase over it. Rows carry the phase in the variant
+// column and the file size as chunk size; threads split the files (or
+// directories) into contiguous ranges.
+void benchmark_metadata(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    if (config.verbosity >= 1) {
+        std::cout << "Testing metadata operations on " << config.meta_files << " files\n";
+    }
+    int threads = config.threads;
+    size_t file_size = config.meta_file_size;
+
+    // All paths are built before timing starts
+    std::vector<std::string> dir_paths;
+    std::vector<std::string> file_paths;
+    if (mkdir(config.meta_root.c_str(), 0755) == -1 && errno != EEXIST) {
+        perror("Could not create metadata tree root");
+        std::exit(EXIT_FAILURE);
+    }
+    for (int d = 0; d < config.meta_dirs; d++) {
+        dir_paths.push_back(std::format("{}/d{}", config.meta_root, d));
+        if (mkdir(dir_paths.back().c_str(), 0755) == -1 && errno != EEXIST) {
+            perror("Could not create metadata tree directory");
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < config.meta_files; i++) {
+        file_paths.push_back(std::format("{}/f{}", dir_paths[i % config.meta_dirs], i));
+    }
+
+    // getdents64 needs a larger buffer than the small files themselves
+    size_t buffer_size = std::max<size_t>(file_size, 64 * 1024);
+    std::vector<void*> buffers(threads);
+    for (int t = 0; t < threads; t++) {
+        buffers[t] = allocate_worker_buffer(config, buffer_size, false, t);
+        fill_write_buffer(buffers[t], buffer_size);
+    }
+    auto run_latency = std::make_unique<LatencyHistogram>();
+
+    const MetadataPhase phases[] = {MetadataPhase::Create, MetadataPhase::Stat, MetadataPhase::OpenReadClose,
+                                    MetadataPhase::Readdir, MetadataPhase::Unlink};
+
+    CpuMeter meter(config.perf);
+
+    RunControl control(config, std::size(phases));
+    for (int run = 0; control.more(run); run++) {
+        for (MetadataPhase phase : phases) {
+            if (phase == MetadataPhase::Stat || phase == MetadataPhase::OpenReadClose
+                || phase == MetadataPhase::Readdir) {
+                invalidate_caches(config, -1, run);
+            }
+
+            const std::vector<std::string>& items = phase == MetadataPhase::Readdir ? dir_paths : file_paths;
+            size_t per_thread = items.size() / threads;
+            size_t op_size = phase == MetadataPhase::Readdir ? buffer_size : file_size;
+
+            std::vector<MetadataWorker> workers(threads);
+            std::vector<std::thread> pool;
+            std::barrier start_line(threads + 1);
+            for (int t = 0; t < threads; t++) {
+                size_t first = per_thread * t;
+                size_t last = t == threads - 1 ? items.size() : first + per_thread;
+                pool.emplace_back([&, t, first, last]() {
+                    MetadataWorker& worker = workers[t];
+                    start_line.arrive_and_wait();
+                    uint64_t last_ns = config.latency ? now_ns() : 0;
+                    for (size_t i = first; i < last; i++) {
+                        if (!metadata_operation(phase, items[i].c_str(), buffers[t], op_size, worker.bytes)) {
+                            worker.error = errno;
+                            break;
+                        }
+                        if (config.latency) {
+                            uint64_t done_ns = now_ns();
+                            worker.latency.record(done_ns - last_ns);
+                            last_ns = done_ns;
+                        }
+                    }
+                });
+                pin_worker(config, pool.back().native_handle(), t);
+            }
+
+            meter.start();
+            auto start = std::chrono::high_resolution_clock::now();
+            start_line.arrive_and_wait();
+            for (std::thread& thread : pool) {
+                thread.join();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> start_stop_diff = end - start;
+
+            run_latency->reset();
+            long long bytes = 0;
+            for (MetadataWorker& worker : workers) {
+                if (worker.error != 0) {
+                    std::cerr << "Metadata " << metadata_phase_name(phase) << " failed: " << strerror(worker.error) << "\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                run_latency->merge(worker.latency);
+                bytes += worker.bytes;
+            }
+            CpuUsage cpu = meter.stop(bytes);
+
+            // Warmup passes are not reported
+            if (run < config.warmup) {
+                continue;
+            }
+
+            double throughput_mbps = (bytes / (1024.0 * 1024.0)) / start_stop_diff.count();
+            double iops = items.size() / start_stop_diff.count();
+            struct BenchmarkResult result = {(int)file_size, run - config.warmup + 1, start_stop_diff.count() * 1000.0,
+                                             throughput_mbps, iops, config.cache_mode, threads, AGGREGATE_THREAD_ID,
+                                             Engine::Metadata, 1, metadata_phase_name(phase),
+                                             AccessPattern::Sequential, run_latency->summary()};
+            result.cpu = cpu;
+            control.record(results, std::move(result), (int)phase);
+        }
+    }
+    control.finish(results);
+
+    for (const std::string& dir_path : dir_paths) {
+        rmdir(dir_path.c_str());
+    }
+    rmdir(config.meta_root.c_str());
+    for (void* buffer : buffers) {
+        free_worker_buffer(buffer);
+    }
+}
+
+// Path and size of every file of the fileset engine
+std::vector<std::pair<std::string, long long>> file_set_files(const BenchmarkConfig& config) {
+    std::vector<std::pair<std::string, long long>> files;
+    for (int i = 0; i < config.set_files; i++) {
+        files.emplace_back(std::format("{}/shard_{:05}.bin", config.set_dir, i),
+                           config.set_sizes[i % config.set_sizes.size()]);
+    }
+    return files;
+}
+
+// Creates the files of the set, keeping those that already have the right size
+void create_file_set(const BenchmarkConfig& config) {
+    if (mkdir(config.set_dir.c_str(), 0755) == -1 && errno != EEXIST) {
+        perror("Could not create file set directory");
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<std::pair<std::string, long long>> files = file_set_files(config);
+    for (size_t i = 0; i < files.size(); i++) {
+        struct stat st;
+        if (stat(files[i].first.c_str(), &st) == 0 && st.st_size == files[i].second) {
+            continue;
+        }
+        generate_file(files[i].first, files[i].second, config.fill, config.generate_threads, config.seed + i);
+    }
+}
+
+// Files still to be read by one thread. The owner takes from the front,
+// idle threads steal from the back.
+struct FileQueue {
+    std::mutex mutex;
+    std::deque<size_t> files;
+};
+
+bool next_file(std::vector<FileQueue>& queues, int self, size_t& file) {
+    {
+        std::lock_guard<std::mutex> lock(queues[self].mutex);
+        if (!queues[self].files.empty()) {
+            file = queues[self].files.front();
+            queues[self].files.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        FileQueue& victim = queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.files.empty()) {
+            file = victim.files.back();
+            victim.files.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+struct FileSetWorker {
+    LatencyHistogram first_byte; // open() to the return of the first read, per file
+    long long bytes = 0;
+    bool rejected = false; // O_DIRECT read rejected with EINVAL
+    int error = 0;
+};
+
+// Reads every file of the set front to back with chunk_size reads. Files
+// are dealt round robin to the threads' queues before every run. The
+// latency columns hold the open-to-first-byte time per file, which is where
+// lookup and DAX window setup costs show up.
+void benchmark_file_set(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    bool direct = config.cache_mode == CacheMode::Direct;
+    int threads = config.threads;
+    std::vector<std::pair<std::string, long long>> files = file_set_files(config);
+    long long total_bytes = 0;
+    for (const auto& file : files) {
+        total_bytes += file.second;
+    }
+
+    std::vector<void*> buffers(threads);
+    for (int t = 0; t < threads; t++) {
+        buffers[t] = allocate_worker_buffer(config, chunk_size, direct, t);
+    }
+    auto run_latency = std::make_unique<LatencyHistogram>();
+    std::string variant = std::format("files={}", files.size());
+
+    CpuMeter meter(config.perf);
+    FuseTracer tracer(config, config.set_dir);
+    ThroughputSampler sampler(config, threads);
+    RunControl control(config);
+    for (int run = 0; control.more(run); run++) {
+        invalidate_caches(config, -1, run);
+        if (config.cache_mode == CacheMode::Fadvise && invalidates_caches(config, run)) {
+            for (const auto& file : files) {
+                int fd = open(file.first.c_str(), O_RDONLY);
+                if (fd == -1 || posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0) {
+                    perror(("Could not evict " + file.first).c_str());
+                    std::exit(EXIT_FAILURE);
+                }
+                close(fd);
+            }
+        }
+
+        std::vector<FileQueue> queues(threads);
+        for (size_t i = 0; i < files.size(); i++) {
+            queues[i % threads].files.push_back(i);
+        }
+
+        std::vector<FileSetWorker> workers(threads);
+        std::vector<std::thread> pool;
+        std::barrier start_line(threads + 1);
+        ProgressCounter* progress = sampler.start();
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back([&, t]() {
+                FileSetWorker& worker = workers[t];
+                start_line.arrive_and_wait();
+                size_t index;
+                while (worker.error == 0 && next_file(queues, t, index)) {
+                    uint64_t open_ns = config.latency ? now_ns() : 0;
+                    int fd = open(files[index].first.c_str(), direct ? O_RDONLY | O_DIRECT : O_RDONLY);
+                    if (fd == -1) {
+                        worker.error = errno;
+                        break;
+                    }
+                    bool first = true;
+                    ssize_t bytes_read;
+                    while ((bytes_read = read(fd, buffers[t], chunk_size)) > 0) {
+                        if (first && config.latency) {
+                            worker.first_byte.record(now_ns() - open_ns);
+                        }
+                        first = false;
+                        worker.bytes += bytes_read;
+                        if (progress) progress[t].add(bytes_read);
+                    }
+                    if (bytes_read == -1) {
+                        worker.rejected = direct && errno == EINVAL;
+                        worker.error = errno;
+                    }
+                    close(fd);
+                }
+            });
+            pin_worker(config, pool.back().native_handle(), t);
+        }
+
+        tracer.start();
+        meter.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        start_line.arrive_and_wait();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        CpuUsage cpu = meter.stop(total_bytes);
+        std::vector<ThroughputSample> samples = sampler.stop();
+        FuseTrace fuse = tracer.stop(total_bytes);
+        std::chrono::duration<double> start_stop_diff = end - start;
+
+        run_latency->reset();
+        long long bytes = 0;
+        bool rejected = false;
+        for (FileSetWorker& worker : workers) {
+            rejected |= worker.rejected;
+            if (worker.error != 0 && !worker.rejected) {
+                std::cerr << "Reading file set failed: " << strerror(worker.error) << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+            run_latency->merge(worker.first_byte);
+            bytes += worker.bytes;
+        }
+        if (rejected) {
+            std::cerr << "O_DIRECT read of " << chunk_size << " bytes rejected, skipping chunk size\n";
+            break;
+        }
+        if (bytes != total_bytes) {
+            std::cerr << "Could not read entire file set!\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Warmup passes are not reported
+        if (run < config.warmup) {
+            continue;
+        }
+
+        double throughput_mbps = (total_bytes / (1024.0 * 1024.0)) / start_stop_diff.count();
+        double files_per_second = files.size() / start_stop_diff.count();
+        struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, start_stop_diff.count() * 1000.0,
+                                         throughput_mbps, files_per_second, config.cache_mode, threads,
+                                         AGGREGATE_THREAD_ID, Engine::FileSet, 1, variant, AccessPattern::Sequential,
+                                         run_latency->summary()};
+        result.cpu = cpu;
+        result.fuse = fuse;
+        result.samples = std::move(samples);
+        control.record(results, std::move(result));
+    }
+    control.finish(results);
+
+    for (void* buffer : buffers) {
+        free_worker_buffer(buffer);
+    }
+}
+
+// Writes file_size bytes to write_path per run. read_time_ms holds the time
+// until the last write returned (including any periodic fdatasync),
+// durable_time_ms the time until the data was durable under the policy.
+void benchmark_chunk_size_write(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    bool direct = config.cache_mode == CacheMode::Direct;
+    bool sequential = config.pattern == AccessPattern::Sequential;
+    void* buffer = allocate_worker_buffer(config, chunk_size, direct, 0);
+    fill_write_buffer(buffer, chunk_size);
+    auto latency = std::make_unique<LatencyHistogram>();
+    AccessPlan plan = plan_accesses(config, chunk_size, 0, config.file_size, config.seed);
+
+    std::string variant = sync_policy_name(config.sync_policy);
+    if (config.sync_policy == SyncPolicy::Fdatasync) {
+        variant += std::format("/{}", config.sync_interval);
+    }
+
+    int flags = O_WRONLY | O_CREAT;
+    if (direct) {
+        flags |= O_DIRECT;
+    }
+    if (config.sync_policy == SyncPolicy::Dsync) {
+        flags |= O_DSYNC;
+    }
+    // Sequential runs write a fresh file like a log writer, the other
+    // patterns overwrite a preallocated one
+    if (sequential) {
+        flags |= O_TRUNC;
+    } else {
+        int prealloc_fd = open(config.write_path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (prealloc_fd == -1 || posix_fallocate(prealloc_fd, 0, config.file_size) != 0
+            || fsync(prealloc_fd) == -1) {
+            perror("Could not preallocate write test file");
+            std::exit(EXIT_FAILURE);
+        }
+        close(prealloc_fd);
+    }
+
+    CpuMeter meter(config.perf);
+
+    RunControl control(config);
+    for (int run = 0; control.more(run); run++) {
+        int test_fd = open(config.write_path.c_str(), flags, 0644);
+        if (test_fd == -1) {
+            perror("Could not open write test file");
+            free_worker_buffer(buffer);
+            std::exit(EXIT_FAILURE);
+        }
+
+        invalidate_caches(config, test_fd, run);
+        latency->reset();
+
+        meter.start();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        long long total_written = 0;
+        long long unsynced = 0;
+        ssize_t bytes_written = 0;
+        size_t op = 0;
+        bool track_latency = config.latency;
+        uint64_t last_ns = track_latency ? now_ns() : 0;
+
+        for (; op < plan.ops; op++) {
+            size_t length = plan.length(op);
+            bytes_written = sequential ? write(test_fd, buffer, length)
+                                       : pwrite(test_fd, buffer, length, plan.offset(op));
+            if (track_latency) {
+                uint64_t done_ns = now_ns();
+                latency->record(done_ns - last_ns);
+                last_ns = done_ns;
+            }
+            if (bytes_written <= 0) break;
+            total_written += bytes_written;
+
+            unsynced += bytes_written;
+            if (config.sync_policy == SyncPolicy::Fdatasync && unsynced >= config.sync_interval) {
+                if (fdatasync(test_fd) == -1) {
+                    perror("fdatasync failed");
+                    std::exit(EXIT_FAILURE);
+                }
+                unsynced = 0;
+                if (track_latency) {
+                    last_ns = now_ns();
+                }
+            }
+        }
+
+        auto returned = std::chrono::high_resolution_clock::now();
+
+        if (bytes_written == -1 && direct && errno == EINVAL) {
+            std::cerr << "O_DIRECT write of " << chunk_size << " bytes rejected, skipping chunk size\n";
+            close(test_fd);
+            break;
+        }
+
+        int sync_result = 0;
+        if (config.sync_policy == SyncPolicy::Fsync) {
+            sync_result = fsync(test_fd);
+        } else if (config.sync_policy == SyncPolicy::Fdatasync && unsynced > 0) {
+            sync_result = fdatasync(test_fd);
+        }
+        if (sync_result == -1) {
+            perror("Syncing write test file failed");
+            std::exit(EXIT_FAILURE);
+        }
+
+        auto durable = std::chrono::high_resolution_clock::now();
+        CpuUsage cpu = meter.stop(plan.bytes);
+
+        if (close(test_fd) == -1) {
+            std::cerr << "Error closing write test file\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (total_written != plan.bytes) {
+            std::cerr << "Could not write entire file!\n";
+            free_worker_buffer(buffer);
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Warmup passes are not reported
+        if (run < config.warmup) {
+            continue;
+        }
+
+        std::chrono::duration<double> return_diff = returned - start;
+        std::chrono::duration<double> durable_diff = durable - start;
+        double throughput_mbps = (plan.bytes / (1024.0 * 1024.0)) / return_diff.count();
+        double iops = op / return_diff.count();
+
+        struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, return_diff.count() * 1000.0,
+                                         throughput_mbps, iops, config.cache_mode, 1, AGGREGATE_THREAD_ID,
+                                         Engine::Write, 1, variant, config.pattern, latency->summary(),
+                                         config.sync_policy == SyncPolicy::None ? -1 : durable_diff.count() * 1000.0};
+        result.cpu = cpu;
+        control.record(results, std::move(result));
+    }
+    control.finish(results);
+
+    free_worker_buffer(buffer);
+}
+
+// Reads iovecs chunk sized buffers per system call, so the number of
+// syscalls can be varied independently of the transfer size per buffer.
+// Every call covers one contiguous range of iovecs chunks, the access
+// pattern decides where the ranges start. With RWF_NOWAIT, calls that would
+// block on I/O fail with EAGAIN and are retried without the flag, the way
+// an event loop hands them to a worker thread.
+struct PreadvBackend {
+    const BenchmarkConfig& config;
+    Engine engine = Engine::Preadv;
+    int qd = 1;
+    std::string variant;
+    AccessPlan plan;
+    int chunk_size = 0;
+    int iovecs;
+    int flag;
+    std::vector<struct iovec> iov;
+    std::vector<struct iovec> rest; // Scratch iovecs for the part of a range a short call left over
+    long long pass_would_block = 0; // Calls that failed with EAGAIN or only returned the cached prefix
+    size_t pass_calls = 0;
+    long long would_block = 0; // Over the reported passes
+    size_t calls = 0;
+
+    PreadvBackend(const BenchmarkConfig& config, int iovecs, int flag)
+        : config(config), variant(std::format("iovecs={}/{}", iovecs, rwf_flag_name(flag))), iovecs(iovecs),
+          flag(flag) {}
+
+    bool prepare(int size) {
+        chunk_size = size;
+        long long call_size = (long long)chunk_size * iovecs;
+        if (call_size > INT32_MAX) {
+            std::cerr << iovecs << " iovecs of " << chunk_size << " bytes exceed 2 GiB per call, skipping\n";
+            return false;
+        }
+        plan = plan_accesses(config, (int)call_size, 0, config.file_size, config.seed);
+
+        // Separate buffers, like the columns of a columnar reader
+        iov.resize(iovecs);
+        for (struct iovec& entry : iov) {
+            entry.iov_base = allocate_worker_buffer(config, chunk_size, config.cache_mode == CacheMode::Direct, 0);
+            entry.iov_len = chunk_size;
+        }
+        rest.resize(iovecs);
+        return true;
+    }
+
+    // Blocking preadv of the range of count iovecs at offset after its first
+    // done bytes, continued until the range is complete or the file ends.
+    // Returns the bytes of the whole range, or -1.
+    ssize_t preadv_rest(int fd, int count, off_t offset, size_t done) {
+        size_t length = 0;
+        for (int i = 0; i < count; i++) {
+            length += iov[i].iov_len;
+        }
+        while (done < length) {
+            // Skip the iovecs already filled and shift into the one done ends in
+            int first = 0;
+            size_t skipped = 0;
+            while (skipped + iov[first].iov_len <= done) {
+                skipped += iov[first].iov_len;
+                first++;
+            }
+            for (int i = first; i < count; i++) {
+                rest[i - first] = iov[i];
+            }
+            rest[0].iov_base = (char*)rest[0].iov_base + (done - skipped);
+            rest[0].iov_len -= done - skipped;
+
+            ssize_t n = preadv(fd, rest.data(), count - first, offset + done);
+            if (n == -1) {
+                return -1;
+            }
+            if (n == 0) {
+                break;
+            }
+            done += n;
+        }
+        return done;
+    }
+
+    void begin_pass(int) {}
+
+    int run(int fd, ReadTally& tally, LatencyHistogram* latency) {
+        ssize_t bytes_read = 0;
+        pass_would_block = 0;
+        uint64_t last_ns = latency ? now_ns() : 0;
+
+        for (size_t op = 0; op < plan.ops; op++) {
+            // Only the last range of the file can be short
+            size_t length = plan.length(op);
+            int count = (int)((length + chunk_size - 1) / chunk_size);
+            iov[count - 1].iov_len = length - (size_t)(count - 1) * chunk_size;
+
+            if (flag == 0) {
+                bytes_read = preadv(fd, iov.data(), count, plan.offset(op));
+            } else {
+                bytes_read = preadv2(fd, iov.data(), count, plan.offset(op), flag);
+                if (bytes_read == -1 && errno == EAGAIN && flag == RWF_NOWAIT) {
+                    pass_would_block++;
+                    bytes_read = preadv(fd, iov.data(), count, plan.offset(op));
+                } else if (bytes_read > 0 && (size_t)bytes_read < length && flag == RWF_NOWAIT) {
+                    // A partly cached range returns only its cached prefix,
+                    // the rest would have blocked as well
+                    pass_would_block++;
+                    bytes_read = preadv_rest(fd, count, plan.offset(op), bytes_read);
+                }
+            }
+            iov[count - 1].iov_len = chunk_size;
+            if (latency) {
+                uint64_t done_ns = now_ns();
+                latency->record(done_ns - last_ns);
+                last_ns = done_ns;
+            }
+            if (bytes_read <= 0) break;
+            tally.add(bytes_read);
+        }
+        pass_calls = tally.ops;
+        return bytes_read == -1 ? errno : 0;
+    }
+
+    bool unsupported(int err) {
+        if (flag == 0 || (err != EOPNOTSUPP && err != EINVAL)) {
+            return false;
+        }
+        std::cerr << "preadv2 with " << rwf_flag_name(flag) << " not supported here: " << strerror(err)
+                  << ", skipping\n";
+        return true;
+    }
+
+    void after_pass(int, bool) {}
+
+    void annotate(BenchmarkResult&) {
+        would_block += pass_would_block;
+        calls += pass_calls;
+    }
+
+    void teardown() {
+        if (flag == RWF_NOWAIT && config.verbosity >= 1 && calls > 0) {
+            std::cout << "  RWF_NOWAIT: " << would_block << " of " << calls << " calls would have blocked\n";
+        }
+        for (struct iovec& entry : iov) {
+            free_worker_buffer(entry.iov_base);
+        }
+    }
+};
+
+void benchmark_chunk_size_preadv(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    for (int iovecs : config.iovec_counts) {
+        for (int flag : config.rwf_flags) {
+            PreadvBackend backend(config, iovecs, flag);
+            run_read_engine(chunk_size, backend, results, config);
+        }
+    }
+}
+
+// Where the zero-copy engines move the test file to
+struct ZeroCopySink {
+    int pipe_fds[2] = {-1, -1}; // splice: file -> pipe -> /dev/null
+    size_t pipe_size = 0;
+    int null_fd = -1;
+    int sockets[2] = {-1, -1}; // sendfile: file -> sockets[0], drained from sockets[1]
+    std::thread drain;
+    int copy_fd = -1; // copy_file_range: reopened and truncated every run
+};
+
+// Moves one chunk of the test file into the sink, retrying short
+// transfers. Returns the bytes moved or -1 with errno set.
+ssize_t transfer_chunk(Engine engine, int test_fd, ZeroCopySink& sink, off_t offset, size_t length) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t moved = -1;
+        if (engine == Engine::Splice) {
+            loff_t in = offset + done;
+            moved = splice(test_fd, &in, sink.pipe_fds[1], NULL, std::min(length - done, sink.pipe_size),
+                           SPLICE_F_MOVE);
+            for (ssize_t left = moved; left > 0;) {
+                ssize_t drained = splice(sink.pipe_fds[0], NULL, sink.null_fd, NULL, left, SPLICE_F_MOVE);
+                if (drained <= 0) {
+                    return -1;
+                }
+                left -= drained;
+            }
+        } else if (engine == Engine::Sendfile) {
+            off_t in = offset + done;
+            moved = sendfile(sink.sockets[0], test_fd, &in, length - done);
+        } else {
+            loff_t in = offset + done;
+            loff_t out = in;
+            moved = copy_file_range(test_fd, &in, sink.copy_fd, &out, length - done, 0);
+        }
+        if (moved <= 0) {
+            return done > 0 ? (ssize_t)done : moved;
+        }
+        done += moved;
+    }
+    return done;
+}
+
+// Moves the test file without copying it through a user space buffer:
+// splice to /dev/null through a pipe, sendfile to a socket pair (as a file
+// server would) or copy_file_range to a second file (as a backup tool
+// would). Rows use the read engine's columns, so they compare directly.
+struct ZeroCopyBackend {
+    const BenchmarkConfig& config;
+    Engine engine;
+    int qd = 1;
+    std::string variant;
+    AccessPlan plan;
+    ZeroCopySink sink;
+
+    ZeroCopyBackend(const BenchmarkConfig& config) : config(config), engine(config.engine) {}
+
+    bool prepare(int chunk_size) {
+        plan = plan_accesses(config, chunk_size, 0, config.file_size, config.seed);
+        if (engine == Engine::Splice) {
+            sink.null_fd = open("/dev/null", O_WRONLY);
+            if (sink.null_fd == -1 || pipe2(sink.pipe_fds, O_CLOEXEC) == -1) {
+                perror("Could not set up splice pipe");
+                std::exit(EXIT_FAILURE);
+            }
+            // Try to fit a whole chunk into the pipe, the kernel caps this at pipe-max-size
+            fcntl(sink.pipe_fds[1], F_SETPIPE_SZ, chunk_size);
+            sink.pipe_size = fcntl(sink.pipe_fds[1], F_GETPIPE_SZ);
+            variant = "pipe=" + size_label(sink.pipe_size);
+        } else if (engine == Engine::Sendfile) {
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sink.sockets) == -1) {
+                perror("Could not create socket pair");
+                std::exit(EXIT_FAILURE);
+            }
+            // The receiving side runs for all runs and stops when the sender shuts down
+            sink.drain = std::thread([this]() {
+                std::vector<char> discard(1024 * 1024);
+                while (read(sink.sockets[1], discard.data(), discard.size()) > 0) {
+                }
+            });
+            pin_worker(config, sink.drain.native_handle(), 1);
+            variant = "unix_socket";
+        }
+        return true;
+    }
+
+    void begin_pass(int fd) {
+        if (engine == Engine::CopyFileRange) {
+            sink.copy_fd = open(config.copy_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            struct stat source_st, copy_st;
+            if (sink.copy_fd == -1 || fstat(fd, &source_st) == -1 || fstat(sink.copy_fd, &copy_st) == -1) {
+                perror(("Could not open copy target " + config.copy_path).c_str());
+                std::exit(EXIT_FAILURE);
+            }
+            variant = source_st.st_dev == copy_st.st_dev ? "same_fs" : "cross_fs";
+        }
+    }
+
+    int run(int fd, ReadTally& tally, LatencyHistogram* latency) {
+        ssize_t moved = 0;
+        uint64_t last_ns = latency ? now_ns() : 0;
+        for (size_t op = 0; op < plan.ops; op++) {
+            moved = transfer_chunk(engine, fd, sink, plan.offset(op), plan.length(op));
+            if (latency) {
+                uint64_t done_ns = now_ns();
+                latency->record(done_ns - last_ns);
+                last_ns = done_ns;
+            }
+            if (moved <= 0) break;
+            tally.add(moved);
+        }
+        return moved == -1 ? errno : 0;
+    }
+
+    bool unsupported(int err) {
+        if (engine != Engine::CopyFileRange || (err != EXDEV && err != EOPNOTSUPP && err != ENOSYS)) {
+            return false;
+        }
+        std::cerr << "copy_file_range to " << config.copy_path << " not supported: " << strerror(err)
+                  << ", skipping chunk size\n";
+        return true;
+    }
+
+    void after_pass(int, bool) {
+        if (sink.copy_fd != -1) {
+            close(sink.copy_fd);
+            sink.copy_fd = -1;
+        }
+    }
+
+    void annotate(BenchmarkResult&) {}
+
+    void teardown() {
+        if (engine == Engine::Splice) {
+            close(sink.pipe_fds[0]);
+            close(sink.pipe_fds[1]);
+            close(sink.null_fd);
+        } else if (engine == Engine::Sendfile) {
+            shutdown(sink.sockets[0], SHUT_WR);
+            sink.drain.join();
+            close(sink.sockets[0]);
+            close(sink.sockets[1]);
+        } else {
+            unlink(config.copy_path.c_str());
+        }
+    }
+};
+
+// Waits until the now_ns() time target_ns, sleeping while it is further
+// away than the timer slack and spinning for the rest
+void wait_until_ns(uint64_t target_ns) {
+    for (uint64_t now = now_ns(); now < target_ns; now = now_ns()) {
+        uint64_t remaining = target_ns - now;
+        if (remaining > 2 * OPEN_LOOP_SPIN_NS) {
+            struct timespec pause = {0, (long)std::min<uint64_t>(remaining - OPEN_LOOP_SPIN_NS, 999999999)};
+            nanosleep(&pause, NULL);
+        }
+    }
+}
+
+struct OpenLoopWorker {
+    LatencyHistogram latency;
+    long long bytes = 0;
+    size_t ops = 0;
+    uint64_t end_ns = 0; // Completion of the worker's last read
+    int error = 0;
+};
+
+// Takes the next slot of the shared schedule, waits for its intended start
+// and reads it. Latency runs from the intended start, so a read that had to
+// wait for a slow predecessor is charged for the wait (no coordinated
+// omission).
+void open_loop_reader(int fd, void* buffer, const AccessPlan& plan, size_t ops, uint64_t start_ns,
+                      double interval_ns, std::atomic<size_t>& next, OpenLoopWorker& worker,
+                      ProgressCounter* progress) {
+    // The default 50 us timer slack would be charged to every read
+    prctl(PR_SET_TIMERSLACK, 1);
+    for (;;) {
+        size_t op = next.fetch_add(1, std::memory_order_relaxed);
+        if (op >= ops) {
+            break;
+        }
+        uint64_t intended_ns = start_ns + (uint64_t)(op * interval_ns);
+        wait_until_ns(intended_ns);
+        ssize_t n = pread(fd, buffer, plan.length(op), plan.offset(op));
+        uint64_t done_ns = now_ns();
+        if (n <= 0) {
+            worker.error = n == 0 ? EIO : errno;
+            break;
+        }
+        worker.latency.record(done_ns - intended_ns);
+        worker.bytes += n;
+        worker.ops++;
+        if (progress) progress->add(n);
+        worker.end_ns = done_ns;
+    }
+}
+
+// Sync engine at a fixed offered load instead of back to back. Reads are
+// scheduled at even intervals for --rate-time seconds (at most one pass of
+// the plan) and --threads workers share the schedule, so a slow read only
+// delays the next one when every worker is busy. Sweeping the rate gives
+// the achieved throughput vs p99 curve of the mount.
+void benchmark_chunk_size_open_loop(int chunk_size, const OfferedLoad& load, std::vector<BenchmarkResult>& results,
+                                    const BenchmarkConfig& config) {
+    bool direct = config.cache_mode == CacheMode::Direct;
+    int threads = config.threads;
+    double iops = load.bytes_per_second > 0 ? (double)load.bytes_per_second / chunk_size : load.iops;
+    double interval_ns = 1e9 / iops;
+    AccessPlan plan = plan_accesses(config, chunk_size, 0, config.file_size, config.seed);
+    size_t ops = std::min<size_t>(plan.ops, std::max<size_t>(1, (size_t)std::ceil(iops * config.rate_time)));
+
+    std::string variant = read_tuning_name(config.tuning);
+    variant += (variant.empty() ? "" : "/") + offered_load_name(load);
+
+    std::vector<void*> buffers(threads);
+    for (int i = 0; i < threads; i++) {
+        buffers[i] = allocate_worker_buffer(config, chunk_size, direct, i);
+    }
+    auto run_latency = std::make_unique<LatencyHistogram>();
+
+    CpuMeter meter(config.perf);
+    FuseTracer tracer(config, config.target_path);
+    ThroughputSampler sampler(config, threads);
+    RunControl control(config);
+    for (int run = 0; control.more(run); run++) {
+        std::vector<int> fds(threads);
+        for (int i = 0; i < threads; i++) {
+            fds[i] = open(config.target_path.c_str(), direct ? O_RDONLY | O_DIRECT : O_RDONLY);
+            if (fds[i] == -1) {
+                perror("Could not open test file");
+                std::exit(EXIT_FAILURE);
+            }
+            if (i == 0) {
+                invalidate_caches(config, fds[i], run);
+            }
+            apply_fadvise_hint(config, fds[i]);
+        }
+
+        // The schedule starts a little ahead so every worker is up by then
+        std::vector<OpenLoopWorker> workers(threads);
+        std::vector<std::thread> pool;
+        std::atomic<size_t> next = 0;
+        ProgressCounter* progress = sampler.start();
+        tracer.start();
+        meter.start();
+        uint64_t start_ns = now_ns() + 1000000;
+        for (int i = 0; i < threads; i++) {
+            pool.emplace_back(open_loop_reader, fds[i], buffers[i], std::cref(plan), ops, start_ns, interval_ns,
+                              std::ref(next), std::ref(workers[i]), progress ? progress + i : NULL);
+            pin_worker(config, pool.back().native_handle(), i);
+        }
+        for (std::thread& worker : pool) {
+            worker.join();
+        }
+
+        long long total_read = 0;
+        size_t total_ops = 0;
+        uint64_t end_ns = start_ns;
+        bool rejected = false;
+        run_latency->reset();
+        for (const OpenLoopWorker& worker : workers) {
+            total_read += worker.bytes;
+            total_ops += worker.ops;
+            end_ns = std::max(end_ns, worker.end_ns);
+            run_latency->merge(worker.latency);
+            if (worker.error == EINVAL && direct) {
+                rejected = true;
+            } else if (worker.error != 0) {
+                std::cerr << "Open-loop read failed: " << strerror(worker.error) << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        CpuUsage cpu = meter.stop(total_read);
+        std::vector<ThroughputSample> samples = sampler.stop();
+        FuseTrace fuse = tracer.stop(total_read);
+
+        for (int fd : fds) {
+            if (close(fd) == -1) {
+                std::cerr << "Error closing test file\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        if (rejected) {
+            std::cerr << "O_DIRECT read of " << chunk_size << " bytes rejected, skipping chunk size\n";
+            break;
+        }
+
+        // Warmup passes are not reported
+        if (run < config.warmup) {
+            continue;
+        }
+
+        // Achieved rates, below the offered load once the mount saturates
+        double seconds = (end_ns - start_ns) / 1e9;
+        struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, seconds * 1000.0,
+                                         (total_read / (1024.0 * 1024.0)) / seconds, total_ops / seconds,
+                                         config.cache_mode, threads, AGGREGATE_THREAD_ID, Engine::Sync, 1, variant,
+                                         config.pattern, run_latency->summary()};
+        result.cpu = cpu;
+        result.fuse = fuse;
+        result.samples = std::move(samples);
+        control.record(results, std::move(result));
+    }
+    control.finish(results);
+
+    for (void* buffer : buffers) {
+        free_worker_buffer(buffer);
+    }
+}
+
+struct JobWorker {
+    LatencyHistogram latency;
+    long long bytes = 0;
+    size_t ops = 0;
+    int error = 0; // errno of the failed operation, 0 when all succeeded
+};
+
+// Body of one mixed engine worker. Readers go through their plan once,
+// the other kinds repeat their operation until stop is set.
+void mixed_worker(JobKind kind, int fd, const AccessPlan* plan, void* buffer, const std::string& path,
+                  const BenchmarkConfig& config, std::barrier<>& start_line, const std::atomic<bool>& stop,
+                  JobWorker& worker) {
+    start_line.arrive_and_wait();
+    uint64_t last_ns = now_ns();
+    auto op_done = [&]() {
+        if (config.latency) {
+            uint64_t done_ns = now_ns();
+            worker.latency.record(done_ns - last_ns);
+            last_ns = done_ns;
+        }
+        worker.ops++;
+    };
+
+    switch (kind) {
+        case JobKind::Read:
+        case JobKind::RandRead:
+            for (size_t op = 0; op < plan->ops; op++) {
+                ssize_t n = pread(fd, buffer, plan->length(op), plan->offset(op));
+                if (n <= 0) {
+                    worker.error = n == 0 ? EIO : errno;
+                    return;
+                }
+                worker.bytes += n;
+                op_done();
+            }
+            break;
+        case JobKind::Append: {
+            // The log wraps at --file-size so long runs do not fill the mount
+            long long unsynced = 0;
+            long long logged = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                ssize_t n = write(fd, buffer, plan->chunk_size);
+                if (n <= 0) {
+                    worker.error = n == 0 ? EIO : errno;
+                    return;
+                }
+                worker.bytes += n;
+                unsynced += n;
+                logged += n;
+                if ((config.sync_policy == SyncPolicy::Fdatasync || config.sync_policy == SyncPolicy::Fsync)
+                    && unsynced >= config.sync_interval) {
+                    int synced = config.sync_policy == SyncPolicy::Fsync ? fsync(fd) : fdatasync(fd);
+                    if (synced == -1) {
+                        worker.error = errno;
+                        return;
+                    }
+                    unsynced = 0;
+                }
+                op_done();
+                if (logged >= config.file_size && ftruncate(fd, 0) == 0) {
+                    logged = 0;
+                }
+            }
+            break;
+        }
+        case JobKind::Metadata:
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (MetadataPhase phase : {MetadataPhase::Create, MetadataPhase::Stat, MetadataPhase::Unlink}) {
+                    if (!metadata_operation(phase, path.c_str(), buffer, config.meta_file_size, worker.bytes)) {
+                        worker.error = errno;
+                        return;
+                    }
+                    op_done();
+                }
+            }
+            break;
+    }
+}
+
+// Runs every job class at once. The readers split the test file into
+// slices and a run lasts until all of them are through; appenders and
+// metadata workers keep going for that long. One aggregate row per class
+// and run, so the interference between classes (head-of-line blocking in
+// a shared FUSE request queue) shows in the per-class latency columns.
+void benchmark_chunk_size_mixed(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    bool direct = config.cache_mode == CacheMode::Direct;
+    std::string mix = job_list_name(config.jobs);
+
+    int readers = 0;
+    for (const JobClass& job : config.jobs) {
+        if (job.kind == JobKind::Read || job.kind == JobKind::RandRead) {
+            readers += job.workers;
+        }
+    }
+
+    // One entry per worker, in class order
+    struct Slot {
+        size_t job;
+        AccessPlan plan;
+        void* buffer;
+        std::string path;
+    };
+    std::vector<Slot> slots;
+    // Slices start on chunk boundaries so O_DIRECT offsets stay aligned
+    long long slice = config.file_size / readers / chunk_size * chunk_size;
+    int reader = 0;
+    int appender = 0;
+    int metadata = 0;
+    for (size_t j = 0; j < config.jobs.size(); j++) {
+        const JobClass& job = config.jobs[j];
+        for (int w = 0; w < job.workers; w++) {
+            Slot slot = {j, {}, NULL, ""};
+            if (job.kind == JobKind::Read || job.kind == JobKind::RandRead) {
+                BenchmarkConfig reader_config = config;
+                reader_config.pattern = job.kind == JobKind::Read ? AccessPattern::Sequential : AccessPattern::Uniform;
+                long long length = reader == readers - 1 ? config.file_size - slice * reader : slice;
+                slot.plan = plan_accesses(reader_config, chunk_size, slice * reader, length, config.seed + reader);
+                reader++;
+            } else {
+                slot.plan.chunk_size = chunk_size;
+            }
+            if (job.kind == JobKind::Append) {
+                slot.path = appender++ == 0 ? config.write_path : std::format("{}.{}", config.write_path, appender - 1);
+            } else if (job.kind == JobKind::Metadata) {
+                slot.path = std::format("{}/job_{}", config.meta_root, metadata++);
+            }
+            long long buffer_size = job.kind == JobKind::Metadata ? std::max<long long>(chunk_size, config.meta_file_size)
+                                                                  : chunk_size;
+            slot.buffer = allocate_worker_buffer(config, buffer_size, direct, slots.size());
+            fill_write_buffer(slot.buffer, (int)buffer_size);
+            slots.push_back(std::move(slot));
+        }
+    }
+    if (metadata > 0 && mkdir(config.meta_root.c_str(), 0755) == -1 && errno != EEXIST) {
+        perror("Could not create metadata root");
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<LatencyHistogram> class_latency(config.jobs.size());
+
+    CpuMeter meter(config.perf);
+    FuseTracer tracer(config, config.target_path);
+    RunControl control(config, config.jobs.size());
+    for (int run = 0; control.more(run); run++) {
+        std::vector<int> fds(slots.size(), -1);
+        bool invalidated = false;
+        for (size_t i = 0; i < slots.size(); i++) {
+            JobKind kind = config.jobs[slots[i].job].kind;
+            if (kind == JobKind::Read || kind == JobKind::RandRead) {
+                fds[i] = open(config.target_path.c_str(), direct ? O_RDONLY | O_DIRECT : O_RDONLY);
+                if (fds[i] != -1 && !invalidated) {
+                    invalidate_caches(config, fds[i], run);
+                    invalidated = true;
+                }
+            } else if (kind == JobKind::Append) {
+                int flags = O_WRONLY | O_CREAT | O_TRUNC | O_APPEND;
+                flags |= direct ? O_DIRECT : 0;
+                flags |= config.sync_policy == SyncPolicy::Dsync ? O_DSYNC : 0;
+                fds[i] = open(slots[i].path.c_str(), flags, 0644);
+            } else {
+                continue;
+            }
+            if (fds[i] == -1) {
+                perror(("Could not open " + (kind == JobKind::Append ? slots[i].path : config.target_path)).c_str());
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        std::vector<JobWorker> workers(slots.size());
+        std::vector<std::thread> threads;
+        std::atomic<bool> stop = false;
+        std::barrier start_line(slots.size() + 1);
+        for (size_t i = 0; i < slots.size(); i++) {
+            threads.emplace_back(mixed_worker, config.jobs[slots[i].job].kind, fds[i], &slots[i].plan,
+                                 slots[i].buffer, std::cref(slots[i].path), std::cref(config), std::ref(start_line),
+                                 std::cref(stop), std::ref(workers[i]));
+            pin_worker(config, threads.back().native_handle(), (int)i);
+        }
+
+        tracer.start();
+        meter.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        start_line.arrive_and_wait();
+        for (size_t i = 0; i < slots.size(); i++) {
+            JobKind kind = config.jobs[slots[i].job].kind;
+            if (kind == JobKind::Read || kind == JobKind::RandRead) {
+                threads[i].join();
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        stop = true;
+        for (std::thread& thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        long long total_bytes = 0;
+        for (const JobWorker& worker : workers) {
+            total_bytes += worker.bytes;
+        }
+        CpuUsage cpu = meter.stop(total_bytes);
+        FuseTrace fuse = tracer.stop(total_bytes);
+        std::chrono::duration<double> start_stop_diff = end - start;
+
+        for (int fd : fds) {
+            if (fd != -1 && close(fd) == -1) {
+                std::cerr << "Error closing job file\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        bool rejected = false;
+        for (size_t i = 0; i < slots.size(); i++) {
+            JobKind kind = config.jobs[slots[i].job].kind;
+            if (workers[i].error == EINVAL && direct && kind != JobKind::Metadata) {
+                rejected = true;
+            } else if (workers[i].error != 0) {
+                std::cerr << job_kind_name(kind) << " job failed: " << strerror(workers[i].error) << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        if (rejected) {
+            std::cerr << "O_DIRECT transfer of " << chunk_size << " bytes rejected, skipping chunk size\n";
+            break;
+        }
+
+        // Warmup passes are not reported
+        if (run < config.warmup) {
+            continue;
+        }
+
+        // Every class is measured over the readers' window
+        for (size_t j = 0; j < config.jobs.size(); j++) {
+            const JobClass& job = config.jobs[j];
+            LatencyHistogram& latency = class_latency[j];
+            latency.reset();
+            long long bytes = 0;
+            size_t ops = 0;
+            int first_worker = -1;
+            for (size_t i = 0; i < slots.size(); i++) {
+                if (slots[i].job == j) {
+                    first_worker = first_worker < 0 ? (int)i : first_worker;
+                    latency.merge(workers[i].latency);
+                    bytes += workers[i].bytes;
+                    ops += workers[i].ops;
+                }
+            }
+            AccessPattern pattern = job.kind == JobKind::RandRead ? AccessPattern::Uniform : AccessPattern::Sequential;
+            std::string variant = std::format("{}:{}/mix={}", job_kind_name(job.kind), job.workers, mix);
+            struct BenchmarkResult result = {chunk_size, run - config.warmup + 1, start_stop_diff.count() * 1000.0,
+                                             (bytes / (1024.0 * 1024.0)) / start_stop_diff.count(),
+                                             ops / start_stop_diff.count(), config.cache_mode, job.workers,
+                                             AGGREGATE_THREAD_ID, Engine::Mixed, 1, variant, pattern,
+                                             latency.summary()};
+            result.cpu = cpu;
+            result.fuse = fuse;
+            result.first_worker = first_worker;
+            control.record(results, std::move(result), (int)j);
+        }
+    }
+    control.finish(results);
+
+    for (const Slot& slot : slots) {
+        free_worker_buffer(slot.buffer);
+        if (config.jobs[slot.job].kind == JobKind::Append) {
+            unlink(slot.path.c_str());
+        }
+    }
+    if (metadata > 0) {
+        rmdir(config.meta_root.c_str());
+    }
+}
+
+// read(2) front to back on one thread, or pread(2) for the other patterns
+struct SyncBackend {
+    const BenchmarkConfig& config;
+    Engine engine = Engine::Sync;
+    int qd = 1;
+    std::string variant;
+    AccessPlan plan;
+    int chunk_size = 0;
+    void* buffer = NULL;
+    std::unique_ptr<Verifier> verifier;
+    bool verify_inline = false;
+    uint64_t verify_ns = 0;
+    VerifyResult verified;
+
+    SyncBackend(const BenchmarkConfig& config) : config(config), variant(read_tuning_name(config.tuning)) {}
+
+    bool prepare(int size) {
+        chunk_size = size;
+        buffer = allocate_worker_buffer(config, chunk_size, config.cache_mode == CacheMode::Direct, 0);
+        plan = plan_accesses(config, chunk_size, 0, config.file_size, config.seed);
+        verifier = std::make_unique<Verifier>(config, plan);
+        verify_inline = verifier->enabled() && config.verify_pass == VerifyPass::Inline;
+        return true;
+    }
+
+    void begin_pass(int) {}
+
+    int run(int fd, ReadTally& tally, LatencyHistogram* latency) {
+        ssize_t bytes_read = 0;
+        verify_ns = 0;
+
+        // Consecutive timestamps are chained, so each read costs one clock call
+        uint64_t last_ns = latency ? now_ns() : 0;
+
+        // Explicit prefetch keeps up to two windows ahead of the reader
+        long long prefetch_window = config.tuning.prefetch_window;
+        off_t prefetched = 0;
+
+        if (plan.sequential) {
+            while (tally.bytes < config.file_size) {
+                if (prefetch_window > 0 && tally.bytes + prefetch_window > prefetched) {
+                    readahead(fd, prefetched, prefetch_window);
+                    prefetched += prefetch_window;
+                    // Issuing the prefetch is not part of the next read's latency
+                    if (latency) last_ns = now_ns();
+                }
+                size_t to_read = (config.file_size - tally.bytes > chunk_size) ?
+                                 chunk_size : (config.file_size - tally.bytes);
+
+                bytes_read = read(fd, buffer, to_read);
+                if (latency) {
+                    uint64_t done_ns = now_ns();
+                    latency->record(done_ns - last_ns);
+                    last_ns = done_ns;
+                }
+                if (bytes_read <= 0) break;
+                if (verify_inline) {
+                    // Kept out of the latency of the next read
+                    uint64_t verify_start = latency ? last_ns : now_ns();
+                    verifier->check(tally.ops, tally.bytes, buffer, bytes_read);
+                    uint64_t verify_end = now_ns();
+                    verify_ns += verify_end - verify_start;
+                    last_ns = verify_end;
+                }
+                tally.add(bytes_read);
+            }
+        } else {
+            for (size_t op = 0; op < plan.ops; op++) {
+                bytes_read = pread(fd, buffer, plan.length(op), plan.offset(op));
+                if (latency) {
+                    uint64_t done_ns = now_ns();
+                    latency->record(done_ns - last_ns);
+                    last_ns = done_ns;
+                }
+                if (bytes_read <= 0) break;
+                if (verify_inline) {
+                    uint64_t verify_start = latency ? last_ns : now_ns();
+                    verifier->check(op, plan.offset(op), buffer, bytes_read);
+                    uint64_t verify_end = now_ns();
+                    verify_ns += verify_end - verify_start;
+                    last_ns = verify_end;
+                }
+                tally.add(bytes_read);
+            }
+        }
+        return bytes_read == -1 ? errno : 0;
+    }
+
+    bool unsupported(int) { return false; }
+
+    void after_pass(int fd, bool complete) {
+        if (verifier->enabled() && !verify_inline && complete) {
+            // Second pass over the same plan, timed on its own
+            uint64_t verify_start = now_ns();
+            for (size_t op = 0; op < plan.ops; op++) {
+                ssize_t length = pread(fd, buffer, plan.length(op), plan.offset(op));
+                if (length <= 0) {
+                    perror("Could not re-read test file for verification");
+                    std::exit(EXIT_FAILURE);
+                }
+                verifier->check(op, plan.offset(op), buffer, length);
+            }
+            verify_ns = now_ns() - verify_start;
+        }
+        verified = verifier->finish(verify_ns / 1e6);
+    }
+
+    void annotate(BenchmarkResult& result) {
+        if (verifier->enabled()) {
+            result.verify = verified;
+        }
+    }
+
+    void teardown() {
+        free_worker_buffer(buffer);
+    }
 };
 
-void write_result(int data_fd, const struct BenchmarkResult& result) {
-    std::string results_str  = std::format("{},{},{:.3f},{:.3f}\n",
-        result.chunk_size,
-        result.run_number,
-        result.read_time_ms,
-        result.throughput_mbps
-    );
-    
-    ssize_t written = write(data_fd, results_str.data(), results_str.size());
-    if (written != results_str.size()) {
-        std::cerr << "Error writing result to file\n";
-        std::exit(EXIT_FAILURE);
+void benchmark_chunk_size_sync(int chunk_size, std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    if (!config.rates.empty()) {
+        for (const OfferedLoad& load : config.rates) {
+            benchmark_chunk_size_open_loop(chunk_size, load, results, config);
+        }
+    } else if (config.threads > 1) {
+        benchmark_chunk_size_parallel(chunk_size, results, config);
+    } else {
+        benchmark_chunk_size_with<SyncBackend>(chunk_size, results, config);
     }
 }
 
-void benchmark_chunk_size(int chunk_size, int data_fd) {
-    void* buffer = std::malloc(chunk_size);
-    if (buffer == NULL) {
-        std::cerr << "Could not allocate chunk buffer!\n";
-        exit(1);
+// read_ahead_kb of the backing device info (bdi) of path, empty when there
+// is none. FUSE mounts such as virtiofs get a bdi named after their anonymous
+// device; partitions of block devices share the bdi of the whole disk.
+std::string bdi_readahead_path(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == -1) {
+        return "";
     }
-    
-    for (int run = 0; run < 30; run++) {
-        // Open test file
-        int test_fd = open("test_file.bin", O_RDONLY);
-        if (test_fd == -1) {
-            std::cerr << "Could not open test file\n";
-            std::free(buffer);
-            std::exit(EXIT_FAILURE);
+    std::string device = std::format("{}:{}", major(st.st_dev), minor(st.st_dev));
+    for (const std::string& candidate : {"/sys/class/bdi/" + device + "/read_ahead_kb",
+                                         "/sys/dev/block/" + device + "/bdi/read_ahead_kb",
+                                         "/sys/dev/block/" + device + "/../bdi/read_ahead_kb"}) {
+        if (access(candidate.c_str(), F_OK) == 0) {
+            return candidate;
         }
-        
-        std::cout << "File descriptor is %d\n" << test_fd;
-        
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        // Read entire file in chunks
-        int total_read = 0;
-        ssize_t bytes_read;
-        
-        while (total_read < FILE_SIZE) {
-            int to_read = (FILE_SIZE - total_read > chunk_size) ? 
-                         chunk_size : (FILE_SIZE - total_read);
-            
-            bytes_read = read(test_fd, buffer, to_read);
-            if (bytes_read <= 0) break;
-            total_read += bytes_read;
+    }
+    return "";
+}
+
+bool read_sysfs_number(const std::string& path, long long& value) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    char text[32] = {};
+    ssize_t n = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (n <= 0) {
+        return false;
+    }
+    value = std::atoll(text);
+    return true;
+}
+
+bool write_sysfs_number(const std::string& path, long long value) {
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd == -1) {
+        return false;
+    }
+    std::string text = std::to_string(value);
+    bool written = write(fd, text.data(), text.size()) == (ssize_t)text.size();
+    close(fd);
+    return written;
+}
+
+// Every combination of the readahead sweep lists
+std::vector<ReadTuning> read_tunings(const BenchmarkConfig& config) {
+    std::vector<ReadTuning> tunings;
+    for (long long bdi_readahead_kb : config.bdi_readaheads_kb) {
+        for (FadviseHint hint : config.fadvise_hints) {
+            for (long long window : config.prefetch_windows) {
+                tunings.push_back({hint, window, bdi_readahead_kb});
+            }
         }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> start_stop_diff = end - start;
+    }
+    return tunings;
+}
 
-        // Close test file
-        if (close(test_fd) == -1) {
-            std::cerr << "Error closing test file\n";
-            std::exit(EXIT_FAILURE);
+// Runs benchmark for every readahead tuning and chunk size of the sweep
+// point. The device readahead is changed for the whole sweep point and
+// restored at the end.
+template <ChunkBenchmark benchmark>
+void sweep_chunk_sizes(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    std::string bdi_path;
+    long long saved_readahead_kb = -1;
+    if (config.bdi_readaheads_kb != std::vector<long long>{-1}) {
+        bdi_path = bdi_readahead_path(config.target_path);
+        if (bdi_path.empty() || !read_sysfs_number(bdi_path, saved_readahead_kb)) {
+            std::cerr << "No read_ahead_kb found for " << config.target_path
+                      << ", skipping the read_ahead_kb sweep points\n";
+            bdi_path.clear();
         }
-        
-        std::cout << "Read " << total_read << "bytes\n";
-        
-        if (total_read != FILE_SIZE) {
-            std::cerr << "Could not read entire file!\n";
-            std::free(buffer);
-            std::exit(EXIT_FAILURE);
+    }
+
+    BenchmarkConfig tuned = config;
+    for (const ReadTuning& tuning : read_tunings(config)) {
+        if (tuning.bdi_readahead_kb >= 0) {
+            if (bdi_path.empty()) {
+                continue;
+            }
+            if (!write_sysfs_number(bdi_path, tuning.bdi_readahead_kb)) {
+                std::cerr << "Could not set " << bdi_path << " to " << tuning.bdi_readahead_kb << ": "
+                          << strerror(errno) << " (are you root?), skipping\n";
+                continue;
+            }
+        }
+        tuned.tuning = tuning;
+        std::string tuning_name = read_tuning_name(tuning);
+        if (config.verbosity >= 1 && !tuning_name.empty()) {
+            std::cout << "Readahead tuning " << tuning_name << "\n";
+        }
+        for (int chunk_size : config.chunk_sizes) {
+            if (config.verbosity >= 1) {
+                std::cout << "Testing " << engine_name(config.engine) << " with " << chunk_size << " byte chunks\n";
+            }
+            benchmark(chunk_size, results, tuned);
         }
-        
-        // Calculate metrics
-        double read_time_ms = start_stop_diff.count() * 1000.0;
-        double throughput_mbps = (FILE_SIZE / (1024.0 * 1024.0)) / start_stop_diff.count();
-        
-        // Write result
-        struct BenchmarkResult result = {chunk_size, run + 1, read_time_ms, throughput_mbps};
-        write_result(data_fd, result);
     }
-    
-    std::free(buffer);
+
+    if (saved_readahead_kb >= 0 && !bdi_path.empty()) {
+        write_sysfs_number(bdi_path, saved_readahead_kb);
+    }
+}
+
+// The files of the set are created once, before the first chunk size
+void benchmark_file_sets(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    create_file_set(config);
+    sweep_chunk_sizes<benchmark_file_set>(results, config);
+}
+
+// Built-in engines, in the order --help lists them
+const EngineRegistration BUILTIN_ENGINES[] = {
+    {Engine::Sync,          "sync",            sweep_chunk_sizes<benchmark_chunk_size_sync>},
+    {Engine::IoUring,       "io_uring",        sweep_chunk_sizes<benchmark_chunk_size_io_uring>},
+    {Engine::Mmap,          "mmap",            benchmark_mmap},
+    {Engine::Write,         "write",           sweep_chunk_sizes<benchmark_chunk_size_write>},
+    {Engine::Metadata,      "metadata",        benchmark_metadata},
+    {Engine::Splice,        "splice",          sweep_chunk_sizes<benchmark_chunk_size_with<ZeroCopyBackend>>},
+    {Engine::Sendfile,      "sendfile",        sweep_chunk_sizes<benchmark_chunk_size_with<ZeroCopyBackend>>},
+    {Engine::CopyFileRange, "copy_file_range", sweep_chunk_sizes<benchmark_chunk_size_with<ZeroCopyBackend>>},
+    {Engine::Preadv,        "preadv",          sweep_chunk_sizes<benchmark_chunk_size_preadv>},
+    {Engine::FileSet,       "fileset",         benchmark_file_sets},
+    {Engine::Mixed,         "mixed",           sweep_chunk_sizes<benchmark_chunk_size_mixed>}
+};
+
+// In-house engines are compiled in from a header of their own, without
+// changes to this file: -DEXTRA_ENGINES='"my_engines.h"'. It defines a
+// backend for run_read_engine (or a whole benchmark function) and registers
+// it, e.g.
+//   static EngineRegistration my_engine(Engine(EXTRA_ENGINE_BASE), "my_engine",
+//                                       sweep_chunk_sizes<benchmark_chunk_size_with<MyBackend>>);
+#ifdef EXTRA_ENGINES
+#include EXTRA_ENGINES
+#endif
+
+// Parses sizes like 100, 8K, 4MiB or 1G (binary units)
+bool parse_size(const char* text, long long& size) {
+    char* end;
+    double value = std::strtod(text, &end);
+    long long multiplier = 1;
+    switch (*end) {
+        case 'k': case 'K': multiplier = 1LL << 10; end++; break;
+        case 'm': case 'M': multiplier = 1LL << 20; end++; break;
+        case 'g': case 'G': multiplier = 1LL << 30; end++; break;
+        case 't': case 'T': multiplier = 1LL << 40; end++; break;
+    }
+    if (multiplier > 1 && *end == 'i') {
+        end++;
+    }
+    if (*end == 'B' || *end == 'b') {
+        end++;
+    }
+    if (end == text || *end != '\0' || value <= 0) {
+        return false;
+    }
+    size = (long long)(value * multiplier);
+    return size > 0;
+}
+
+// Parses a comma separated chunk list. Every item is a size, a doubling
+// sweep START..END or a linear sweep START..END+STEP, e.g. "100,1K,8K..256K+8K"
+// or "4K..16M".
+bool parse_chunk_list(const std::string& text, std::vector<int>& chunk_sizes) {
+    chunk_sizes.clear();
+    size_t item_start = 0;
+    while (item_start <= text.size()) {
+        size_t item_end = text.find(',', item_start);
+        if (item_end == std::string::npos) {
+            item_end = text.size();
+        }
+        std::string item = text.substr(item_start, item_end - item_start);
+        item_start = item_end + 1;
+
+        size_t range = item.find("..");
+        if (range == std::string::npos) {
+            long long size;
+            if (!parse_size(item.c_str(), size) || size > INT32_MAX) {
+                return false;
+            }
+            chunk_sizes.push_back((int)size);
+            continue;
+        }
+
+        std::string last = item.substr(range + 2);
+        long long start, end, step = 0;
+        size_t plus = last.find('+');
+        if (plus != std::string::npos) {
+            if (!parse_size(last.substr(plus + 1).c_str(), step)) {
+                return false;
+            }
+            last = last.substr(0, plus);
+        }
+        if (!parse_size(item.substr(0, range).c_str(), start) || !parse_size(last.c_str(), end)
+            || start > end || end > INT32_MAX) {
+            return false;
+        }
+        for (long long size = start; size <= end; size = step ? size + step : size * 2) {
+            chunk_sizes.push_back((int)size);
+        }
+    }
+    return !chunk_sizes.empty();
+}
+
+// Parses a list of readahead sizes: "0" or any item parse_chunk_list accepts
+bool parse_window_list(const std::string& text, std::vector<long long>& sizes) {
+    sizes.clear();
+    size_t item_start = 0;
+    while (item_start <= text.size()) {
+        size_t item_end = text.find(',', item_start);
+        if (item_end == std::string::npos) {
+            item_end = text.size();
+        }
+        std::string item = text.substr(item_start, item_end - item_start);
+        item_start = item_end + 1;
+
+        std::vector<int> expanded;
+        if (item == "0") {
+            sizes.push_back(0);
+        } else if (parse_chunk_list(item, expanded)) {
+            sizes.insert(sizes.end(), expanded.begin(), expanded.end());
+        } else {
+            return false;
+        }
+    }
+    return !sizes.empty();
+}
+
+// Parses offered loads like 1000,5000 (reads per second) or 100M,400M
+// (bytes per second, binary units like --chunks)
+bool parse_rate_list(const std::string& text, std::vector<OfferedLoad>& rates) {
+    rates.clear();
+    size_t item_start = 0;
+    while (item_start <= text.size()) {
+        size_t item_end = text.find(',', item_start);
+        if (item_end == std::string::npos) {
+            item_end = text.size();
+        }
+        std::string item = text.substr(item_start, item_end - item_start);
+        item_start = item_end + 1;
+
+        OfferedLoad load;
+        char* end;
+        load.iops = std::strtod(item.c_str(), &end);
+        if (end != item.c_str() && *end == '\0' && load.iops > 0) {
+            rates.push_back(load);
+        } else if (parse_size(item.c_str(), load.bytes_per_second)) {
+            load.iops = 0;
+            rates.push_back(load);
+        } else {
+            return false;
+        }
+    }
+    return !rates.empty();
+}
+
+// Parses CPU lists like 0-3,8,10-11 (the cpuset/taskset list format)
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    size_t item_start = 0;
+    while (item_start <= text.size()) {
+        size_t item_end = text.find(',', item_start);
+        if (item_end == std::string::npos) {
+            item_end = text.size();
+        }
+        std::string item = text.substr(item_start, item_end - item_start);
+        item_start = item_end + 1;
+
+        char* end;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end != item.c_str() && *end == '-') {
+            const char* range = end + 1;
+            last = std::strtol(range, &end, 10);
+            if (end == range) {
+                return false;
+            }
+        }
+        if (end == item.c_str() || *end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            cpus.push_back((int)cpu);
+        }
+    }
+    return !cpus.empty();
+}
+
+// Parses job classes like read:4,randread:2,append,metadata:1 (N defaults to 1)
+bool parse_job_list(const std::string& text, std::vector<JobClass>& jobs) {
+    jobs.clear();
+    size_t item_start = 0;
+    while (item_start <= text.size()) {
+        size_t item_end = text.find(',', item_start);
+        if (item_end == std::string::npos) {
+            item_end = text.size();
+        }
+        std::string item = text.substr(item_start, item_end - item_start);
+        item_start = item_end + 1;
+
+        size_t colon = item.find(':');
+        std::string kind_name = item.substr(0, colon);
+        int workers = colon == std::string::npos ? 1 : std::atoi(item.c_str() + colon + 1);
+        if (workers < 1) {
+            return false;
+        }
+        bool known = false;
+        for (JobKind kind : {JobKind::Read, JobKind::RandRead, JobKind::Append, JobKind::Metadata}) {
+            if (kind_name == job_kind_name(kind)) {
+                jobs.push_back({kind, workers});
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return !jobs.empty();
+}
+
+void print_usage(const char* program) {
+    // Listed from the registry, so in-house engines show up too
+    std::string engines;
+    size_t line_length = 0;
+    for (const EngineInfo& info : engine_registry()) {
+        std::string item = std::string(info.name) + (info.engine == Engine::Sync ? " (default)" : "");
+        if (!engines.empty()) {
+            engines += ",";
+            if (line_length + item.size() + 2 > 72) {
+                engines += "\n                          ";
+                line_length = 0;
+            } else {
+                engines += " ";
+                line_length += 2;
+            }
+        }
+        engines += item;
+        line_length += item.size();
+    }
+
+    std::cerr << "Usage: " << program << " [--config=FILE] [--target=PATH] [--targets=LIST] [--file-size=SIZE] [--chunks=LIST]"
+              << " [--runs=N] [--warmup=N]\n"
+              << "       [--ci-width=PERCENT] [--min-runs=N] [--time-budget=SECONDS]\n"
+              << "       [--cache=MODE] [--drop-hook=COMMAND] [--phases] [--threads=N] [--thread-layout=LAYOUT]"
+              << " [--engine=ENGINE] [--qd=LIST] [--iovecs=LIST] [--rwf=LIST] [--jobs=LIST]\n"
+              << "       [--rate=LIST] [--rate-time=SECONDS] [--cpus=LIST] [--mem-node=NODE] [--buffers=LIST]\n"
+              << "       [--sample-interval=MS]\n"
+              << "       [--mmap-fault=FAULT] [--madvise=ADVICE] [--mmap-access=ACCESS] [--no-latency] [--perf]\n"
+              << "       [--trace-fuse] [--pattern=PATTERN] [--stride=SIZE] [--zipf-theta=THETA] [--seed=N]\n"
+              << "       [--fadvise=LIST] [--prefetch=LIST] [--bdi-readahead=LIST]\n"
+              << "       [--write-target=PATH] [--sync=POLICY] [--sync-interval=SIZE] [--copy-target=PATH]\n"
+              << "       [--meta-root=PATH] [--meta-files=N] [--meta-dirs=N] [--meta-file-size=SIZE]\n"
+              << "       [--set-dir=PATH] [--set-files=N] [--set-sizes=LIST]\n"
+              << "       [--generate] [--fill=FILL] [--gen-threads=N] [--verify=MODE] [--verify-pass=PASS]\n"
+              << "       [--jsonl=PATH] [--label=KEY=VALUE] [--verbosity=N] [-v]\n"
+              << "  --config=FILE           read options from FILE, one option=value per line ('#' comments);\n"
+              << "                          command line options override the file\n"
+              << "  --target=PATH           test file to read (default test_file.bin)\n"
+              << "  --targets=LIST          run the matrix once per directory, e.g. tmpfs=/dev/shm,virtiofs=/mnt/share;\n"
+              << "                          the test file is copied into every directory, the first one is the baseline\n"
+              << "  --file-size=SIZE        bytes read per pass, e.g. 64M or 10G (default: size of the test file)\n"
+              << "  --chunks=LIST           chunk sizes, e.g. 100,1K or 4K..16M (doubling) or 8K..256K+8K\n"
+              << "                          (default " DEFAULT_CHUNKS ")\n"
+              << "  --runs=N                measured runs per chunk size (default " << DEFAULT_RUNS << ")\n"
+              << "  --warmup=N              unreported warmup runs before the measured runs (default 0)\n"
+              << "  --ci-width=PERCENT      stop a configuration early once the 95% CI of the median read time\n"
+              << "                          is narrower than PERCENT of the median; --runs becomes the maximum\n"
+              << "  --min-runs=N            measured runs before the CI is checked (default 10)\n"
+              << "  --time-budget=SECONDS   stop a configuration after SECONDS, at least one run is measured\n"
+              << "  --cache=MODE            buffered (default), direct, fadvise or drop_caches\n"
+              << "  --drop-hook=COMMAND     shell command run before every run, e.g. to drop host caches\n"
+              << "  --phases                invalidate (fadvise, drop_caches or the drop hook, e.g. a remount)\n"
+              << "                          before the first reported run only: run 1 is the cold phase, the\n"
+              << "                          rest are warm, recorded in the phase column\n"
+              << "  --threads=N             parallel pread (sync engine) or metadata workers, up to the core count\n"
+              << "                          (default 1)\n"
+              << "  --thread-layout=LAYOUT  slice (default): threads split the test file,\n"
+              << "                          file: every thread reads its own <test file>.<thread>\n"
+              << "  --engine=ENGINE         " << engines << "\n"
+              << "  --jobs=LIST             mixed engine: worker classes run at the same time, KIND:N with KIND read,\n"
+              << "                          randread, append or metadata (default read:4,append:1,metadata:1).\n"
+              << "                          Readers split the test file, a run ends when they are done; appenders\n"
+              << "                          log to --write-target with --sync (fsync every --sync-interval too) and\n"
+              << "                          metadata workers cycle create/stat/unlink under --meta-root meanwhile\n"
+              << "  --qd=LIST               comma separated io_uring queue depths (default 1,2,4,...,128)\n"
+              << "  --iovecs=LIST           preadv engine: chunk sized iovecs per call (default 1,4,16,64)\n"
+              << "  --rwf=LIST              preadv engine: none (preadv, default), nowait (RWF_NOWAIT, falls back\n"
+              << "                          to a blocking read when uncached) or hipri (RWF_HIPRI)\n"
+              << "  --rate=LIST             sync engine: open-loop runs at each offered load, reads per second\n"
+              << "                          (5000) or bytes per second (200M); latency counts from the intended\n"
+              << "                          start of every read and --threads workers share the schedule\n"
+              << "  --rate-time=SECONDS     length of an open-loop run, at most one pass over the file (default 5)\n"
+              << "  --cpus=LIST             pin worker i (the main thread is worker 0) to the i-th CPU of the list,\n"
+              << "                          e.g. 0-3,8; rows record the CPU in the cpu column\n"
+              << "  --mem-node=NODE         bind chunk buffers to NUMA node NODE, or local (the node of the worker's\n"
+              << "                          --cpus entry); rows record it in the numa_node column\n"
+              << "  --buffers=LIST          chunk buffer strategies to sweep: malloc (default, faulted in by the\n"
+              << "                          first run), populate (MAP_POPULATE), thp (MADV_HUGEPAGE), hugetlb\n"
+              << "                          (MAP_HUGETLB, needs vm.nr_hugepages) or arena (one prefaulted region\n"
+              << "                          reused across chunk sizes); recorded in the buffer column\n"
+              << "  --sample-interval=MS    sample cumulative bytes and operations every MS milliseconds of a run\n"
+              << "                          into benchmark_timeseries.csv (sync, io_uring, preadv, mmap, splice,\n"
+              << "                          sendfile, copy_file_range and file set engines)\n"
+              << "  --mmap-fault=FAULT      mmap engine: demand (default), populate (MAP_POPULATE) or cold\n"
+              << "  --madvise=ADVICE        mmap engine: normal, sequential (default) or hugepage\n"
+              << "  --mmap-access=ACCESS    mmap engine: touch (one byte per page) or checksum (default)\n"
+              << "  --no-latency            do not time individual reads (no latency percentile columns)\n"
+              << "  --perf                  also count cycles, instructions and page faults with perf_event_open\n"
+              << "  --trace-fuse            count the FUSE requests of every run and their mean READ size with the\n"
+              << "                          fuse tracepoints (needs root and tracefs), and the interrupts of the\n"
+              << "                          virtio device behind the target per MiB\n"
+              << "  --pattern=PATTERN       sequential (default), reverse, strided, uniform or zipfian\n"
+              << "  --stride=SIZE           distance between strided reads (default 1M)\n"
+              << "  --zipf-theta=THETA      skew of the zipfian pattern, 0 < THETA < 1 (default 0.99)\n"
+              << "  --seed=N                seed of the random patterns (default 42)\n"
+              << "  --fadvise=LIST          sync engine: fadvise hints to sweep, none (default), normal, sequential,\n"
+              << "                          random or willneed\n"
+              << "  --prefetch=LIST         sync engine, sequential pattern: readahead(2) windows to sweep, e.g.\n"
+              << "                          0,128K..4M (default 0, no explicit prefetch)\n"
+              << "  --bdi-readahead=LIST    sync engine: read_ahead_kb values of the device backing the test\n"
+              << "                          file to sweep in bytes, multiples of 1K, e.g. 0,128K,1M (needs root,\n"
+              << "                          restored afterwards)\n"
+              << "  --write-target=PATH     file written by the write engine (default write_test_file.bin)\n"
+              << "  --copy-target=PATH      destination of the copy_file_range engine, on the same or another\n"
+              << "                          mount (default copy_test_file.bin, removed afterwards)\n"
+              << "  --sync=POLICY           write engine durability: none (default), fdatasync, fsync or dsync\n"
+              << "  --sync-interval=SIZE    bytes written between fdatasync calls (default 1M)\n"
+              << "  --meta-root=PATH        directory the metadata engine builds its tree in (default metadata_tree)\n"
+              << "  --meta-files=N          small files in the metadata tree (default 10000)\n"
+              << "  --meta-dirs=N           directories the files are spread over (default 100)\n"
+              << "  --meta-file-size=SIZE   size of every small file (default 4K)\n"
+              << "  --set-dir=PATH          directory of the fileset engine's files (default file_set), files of\n"
+              << "                          the right size are reused\n"
+              << "  --set-files=N           files in the set (default 100)\n"
+              << "  --set-sizes=LIST        file sizes, cycled over the files, e.g. 64K,1M,16M (default 1M)\n"
+              << "  --generate              write --file-size bytes to the test file and exit\n"
+              << "  --create                write the test file like --generate before benchmarking when it does\n"
+              << "                          not exist yet; an existing file is never overwritten\n"
+              << "  --fill=FILL             generated data: random (incompressible, default) or zero\n"
+              << "  --gen-threads=N         parallel writers of the generator (default 1)\n"
+              << "  --verify=MODE           sync (one thread) and mmap engines: none (default), pattern (data of\n"
+              << "                          --generate with the same --seed and --fill) or crc32c (against an\n"
+              << "                          untimed buffered reference pass); corrupt reads fail the run\n"
+              << "  --verify-pass=PASS      inline (after every read, timed, default) or separate (second pass)\n"
+              << "  --jsonl=PATH            also write the results as JSON Lines, after a host line (kernel, CPU,\n"
+              << "                          vCPUs, git hash, timestamp) and a line per target (mount options, DAX)\n"
+              << "  --label=KEY=VALUE       recorded in the host line, e.g. virtiofs_cache=auto (repeatable)\n"
+              << "  --verbosity=N           0: errors only, 1: progress per chunk size (default), 2: every run\n"
+              << "  -v, --verbose           same as --verbosity=2\n";
+}
+
+// Turns every "option=value" line of a config file into a "--option=value"
+// argument. Blank lines and lines starting with '#' are ignored.
+bool load_config_file(const char* path, std::vector<std::string>& arguments) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        std::string option(line);
+        option.erase(0, option.find_first_not_of(" \t"));
+        option.erase(option.find_last_not_of(" \t\r\n") + 1);
+        if (option.empty() || option[0] == '#') {
+            continue;
+        }
+        arguments.push_back(option.rfind("--", 0) == 0 ? option : "--" + option);
+    }
+    fclose(file);
+    return true;
+}
+
+// Options without a short form, numbered past every option character
+enum {
+    OPTION_RATE_TIME = 256,
+    OPTION_CPUS,
+    OPTION_MEM_NODE,
+    OPTION_BUFFERS,
+    OPTION_SAMPLE_INTERVAL,
+    OPTION_PHASES,
+    OPTION_CREATE,
+    OPTION_TRACE_FUSE
+};
+
+// Fills config from the command line. Returns false when the program
+// should exit right away with exit_code (bad arguments or --help).
+bool parse_arguments(int argc, char** argv, BenchmarkConfig& config, int& exit_code) {
+    // Options from --config come first so the command line can override them
+    std::vector<std::string> arguments = {argv[0]};
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument.rfind("--config=", 0) == 0 || argument == "--config") {
+            const char* path = argument == "--config" ? (i + 1 < argc ? argv[++i] : "") : argv[i] + 9;
+            if (!load_config_file(path, arguments)) {
+                std::cerr << "Could not read config file: " << path << "\n";
+                exit_code = 1;
+                return false;
+            }
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--config") {
+            i++;
+        } else if (argument.rfind("--config=", 0) != 0) {
+            arguments.push_back(argument);
+        }
+    }
+    std::vector<char*> args;
+    for (std::string& argument : arguments) {
+        args.push_back(argument.data());
+    }
+    args.push_back(NULL);
+    argc = (int)arguments.size();
+    argv = args.data();
+
+    if (!parse_chunk_list(DEFAULT_CHUNKS, config.chunk_sizes)) {
+        std::cerr << "Invalid default chunk list\n";
+        exit_code = 1;
+        return false;
+    }
+
+    static const struct option long_options[] = {
+        {"target",    required_argument, NULL, 'T'},
+        {"targets",   required_argument, NULL, 'B'},
+        {"file-size", required_argument, NULL, 'S'},
+        {"chunks",    required_argument, NULL, 'C'},
+        {"runs",      required_argument, NULL, 'r'},
+        {"warmup",    required_argument, NULL, 'w'},
+        {"ci-width",  required_argument, NULL, 'i'},
+        {"min-runs",  required_argument, NULL, 'N'},
+        {"time-budget", required_argument, NULL, 'b'},
+        {"cache",     required_argument, NULL, 'c'},
+        {"drop-hook", required_argument, NULL, 'd'},
+        {"phases",    no_argument,       NULL, OPTION_PHASES},
+        {"threads",   required_argument, NULL, 't'},
+        {"thread-layout", required_argument, NULL, 'l'},
+        {"engine",    required_argument, NULL, 'e'},
+        {"qd",        required_argument, NULL, 'q'},
+        {"iovecs",    required_argument, NULL, 'x'},
+        {"rwf",       required_argument, NULL, 'G'},
+        {"mmap-fault", required_argument, NULL, 'F'},
+        {"madvise",   required_argument, NULL, 'M'},
+        {"mmap-access", required_argument, NULL, 'A'},
+        {"no-latency", no_argument,      NULL, 'L'},
+        {"perf",      no_argument,       NULL, 'P'},
+        {"trace-fuse", no_argument,      NULL, OPTION_TRACE_FUSE},
+        {"pattern",   required_argument, NULL, 'p'},
+        {"stride",    required_argument, NULL, 's'},
+        {"zipf-theta", required_argument, NULL, 'z'},
+        {"seed",      required_argument, NULL, 'R'},
+        {"fadvise",   required_argument, NULL, 'a'},
+        {"prefetch",  required_argument, NULL, 'f'},
+        {"bdi-readahead", required_argument, NULL, 'k'},
+        {"write-target", required_argument, NULL, 'W'},
+        {"copy-target", required_argument, NULL, 'o'},
+        {"sync",      required_argument, NULL, 'y'},
+        {"sync-interval", required_argument, NULL, 'Y'},
+        {"meta-root", required_argument, NULL, 'm'},
+        {"meta-files", required_argument, NULL, 'n'},
+        {"meta-dirs", required_argument, NULL, 'D'},
+        {"meta-file-size", required_argument, NULL, 'Z'},
+        {"set-dir",   required_argument, NULL, 'u'},
+        {"set-files", required_argument, NULL, 'E'},
+        {"set-sizes", required_argument, NULL, 'H'},
+        {"generate",  no_argument,       NULL, 'g'},
+        {"create",    no_argument,       NULL, OPTION_CREATE},
+        {"fill",      required_argument, NULL, 'j'},
+        {"gen-threads", required_argument, NULL, 'K'},
+        {"verify",    required_argument, NULL, 'X'},
+        {"verify-pass", required_argument, NULL, 'Q'},
+        {"jsonl",     required_argument, NULL, 'J'},
+        {"jobs",      required_argument, NULL, 'I'},
+        {"rate",      required_argument, NULL, 'U'},
+        {"rate-time", required_argument, NULL, OPTION_RATE_TIME},
+        {"cpus",      required_argument, NULL, OPTION_CPUS},
+        {"mem-node",  required_argument, NULL, OPTION_MEM_NODE},
+        {"buffers",   required_argument, NULL, OPTION_BUFFERS},
+        {"sample-interval", required_argument, NULL, OPTION_SAMPLE_INTERVAL},
+        {"label",     required_argument, NULL, 'O'},
+        {"verbosity", required_argument, NULL, 'V'},
+        {"verbose",   no_argument,       NULL, 'v'},
+        {"help",      no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "T:B:S:C:r:w:i:N:b:c:d:t:l:e:q:x:G:F:M:A:LPp:s:z:R:a:f:k:W:o:y:Y:m:n:D:Z:u:E:H:gj:K:X:Q:J:O:I:U:V:vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'T':
+                config.target_path = optarg;
+                break;
+            case 'B': {
+                // name=directory items, a bare directory is its own name
+                config.targets.clear();
+                std::string list = optarg;
+                size_t item_start = 0;
+                while (item_start < list.size()) {
+                    size_t item_end = std::min(list.find(',', item_start), list.size());
+                    std::string item = list.substr(item_start, item_end - item_start);
+                    item_start = item_end + 1;
+                    size_t equals = item.find('=');
+                    BenchmarkTarget target;
+                    target.name = equals == std::string::npos ? item : item.substr(0, equals);
+                    target.directory = equals == std::string::npos ? item : item.substr(equals + 1);
+                    if (target.name.empty() || target.directory.empty()) {
+                        std::cerr << "Invalid target: " << item << "\n";
+                        exit_code = 1;
+                        return false;
+                    }
+                    config.targets.push_back(target);
+                }
+                break;
+            }
+            case 'S':
+                if (!parse_size(optarg, config.file_size)) {
+                    std::cerr << "Invalid file size: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'C':
+                if (!parse_chunk_list(optarg, config.chunk_sizes)) {
+                    std::cerr << "Invalid chunk list: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'r':
+                config.runs = std::atoi(optarg);
+                if (config.runs < 1) {
+                    std::cerr << "Run count must be at least 1\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'w':
+                config.warmup = std::atoi(optarg);
+                if (config.warmup < 0) {
+                    std::cerr << "Warmup count cannot be negative\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'i':
+                config.ci_width = std::atof(optarg) / 100.0;
+                if (config.ci_width <= 0) {
+                    std::cerr << "CI width must be a positive percentage\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'N':
+                config.min_runs = std::atoi(optarg);
+                if (config.min_runs < 1) {
+                    std::cerr << "Minimum run count must be at least 1\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'b':
+                config.time_budget = std::atof(optarg);
+                if (config.time_budget <= 0) {
+                    std::cerr << "Time budget must be a positive number of seconds\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'c':
+                if (!parse_cache_mode(optarg, config.cache_mode)) {
+                    std::cerr << "Unknown cache mode: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'd':
+                config.drop_hook = optarg;
+                break;
+            case 't': {
+                int max_threads = std::max(1u, std::thread::hardware_concurrency());
+                config.threads = std::atoi(optarg);
+                if (config.threads < 1 || config.threads > max_threads) {
+                    std::cerr << "Thread count must be between 1 and " << max_threads << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            }
+            case 'l':
+                if (std::string(optarg) == "slice") {
+                    config.thread_layout = ThreadLayout::Slice;
+                } else if (std::string(optarg) == "file") {
+                    config.thread_layout = ThreadLayout::File;
+                } else {
+                    std::cerr << "Unknown thread layout: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'e': {
+                const EngineInfo* info = find_engine(std::string(optarg));
+                if (info == NULL) {
+                    std::cerr << "Unknown engine: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                config.engine = info->engine;
+                break;
+            }
+            case 'q': {
+                config.queue_depths.clear();
+                char* rest = optarg;
+                while (*rest != '\0') {
+                    int qd = (int)std::strtol(rest, &rest, 10);
+                    if (qd < 1 || qd > MAX_QUEUE_DEPTH || (*rest != ',' && *rest != '\0')) {
+                        std::cerr << "Queue depths must be a comma separated list of values between 1 and "
+                                  << MAX_QUEUE_DEPTH << "\n";
+                        exit_code = 1;
+                        return false;
+                    }
+                    config.queue_depths.push_back(qd);
+                    if (*rest == ',') {
+                        rest++;
+                    }
+                }
+                break;
+            }
+            case 'x': {
+                config.iovec_counts.clear();
+                char* rest = optarg;
+                while (*rest != '\0') {
+                    int count = (int)std::strtol(rest, &rest, 10);
+                    if (count < 1 || count > MAX_IOVECS || (*rest != ',' && *rest != '\0')) {
+                        std::cerr << "iovec counts must be a comma separated list of values between 1 and "
+                                  << MAX_IOVECS << "\n";
+                        exit_code = 1;
+                        return false;
+                    }
+                    config.iovec_counts.push_back(count);
+                    if (*rest == ',') {
+                        rest++;
+                    }
+                }
+                break;
+            }
+            case 'G': {
+                config.rwf_flags.clear();
+                std::string list = optarg;
+                size_t item_start = 0;
+                while (item_start <= list.size()) {
+                    size_t item_end = std::min(list.find(',', item_start), list.size());
+                    int flag;
+                    if (!parse_rwf_flag(list.substr(item_start, item_end - item_start), flag)) {
+                        std::cerr << "Unknown preadv flag in: " << optarg << "\n";
+                        print_usage(argv[0]);
+                        exit_code = 1;
+                        return false;
+                    }
+                    config.rwf_flags.push_back(flag);
+                    item_start = item_end + 1;
+                }
+                break;
+            }
+            case 'F':
+                if (std::string(optarg) == mmap_fault_name(MmapFault::Demand)) {
+                    config.mmap_fault = MmapFault::Demand;
+                } else if (std::string(optarg) == mmap_fault_name(MmapFault::Populate)) {
+                    config.mmap_fault = MmapFault::Populate;
+                } else if (std::string(optarg) == mmap_fault_name(MmapFault::Cold)) {
+                    config.mmap_fault = MmapFault::Cold;
+                } else {
+                    std::cerr << "Unknown mmap fault mode: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'M':
+                if (std::string(optarg) == mmap_advice_name(MmapAdvice::Normal)) {
+                    config.mmap_advice = MmapAdvice::Normal;
+                } else if (std::string(optarg) == mmap_advice_name(MmapAdvice::Sequential)) {
+                    config.mmap_advice = MmapAdvice::Sequential;
+                } else if (std::string(optarg) == mmap_advice_name(MmapAdvice::Hugepage)) {
+                    config.mmap_advice = MmapAdvice::Hugepage;
+                } else {
+                    std::cerr << "Unknown madvise advice: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'A':
+                if (std::string(optarg) == mmap_access_name(MmapAccess::Touch)) {
+                    config.mmap_access = MmapAccess::Touch;
+                } else if (std::string(optarg) == mmap_access_name(MmapAccess::Checksum)) {
+                    config.mmap_access = MmapAccess::Checksum;
+                } else {
+                    std::cerr << "Unknown mmap access: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'L':
+                config.latency = false;
+                break;
+            case 'P':
+                config.perf = true;
+                break;
+            case 'p':
+                if (!parse_access_pattern(optarg, config.pattern)) {
+                    std::cerr << "Unknown access pattern: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 's':
+                if (!parse_size(optarg, config.stride)) {
+                    std::cerr << "Invalid stride: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'z':
+                config.zipf_theta = std::atof(optarg);
+                if (config.zipf_theta <= 0 || config.zipf_theta >= 1) {
+                    std::cerr << "Zipf theta must be between 0 and 1 (exclusive)\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'R':
+                config.seed = std::strtoull(optarg, NULL, 10);
+                break;
+            case 'a': {
+                config.fadvise_hints.clear();
+                std::string list = optarg;
+                size_t item_start = 0;
+                while (item_start <= list.size()) {
+                    size_t item_end = std::min(list.find(',', item_start), list.size());
+                    FadviseHint hint;
+                    if (!parse_fadvise_hint(list.substr(item_start, item_end - item_start), hint)) {
+                        std::cerr << "Unknown fadvise hint in: " << optarg << "\n";
+                        print_usage(argv[0]);
+                        exit_code = 1;
+                        return false;
+                    }
+                    config.fadvise_hints.push_back(hint);
+                    item_start = item_end + 1;
+                }
+                break;
+            }
+            case 'f':
+                if (!parse_window_list(optarg, config.prefetch_windows)) {
+                    std::cerr << "Invalid prefetch window list: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'k':
+                if (!parse_window_list(optarg, config.bdi_readaheads_kb)) {
+                    std::cerr << "Invalid read_ahead_kb list: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                for (long long& size : config.bdi_readaheads_kb) {
+                    // sysfs takes whole KiB, so e.g. 100 or 1536 bytes would silently round down
+                    if (size % 1024 != 0) {
+                        std::cerr << "read_ahead_kb values must be multiples of 1K (e.g. 128K): " << size << "\n";
+                        exit_code = 1;
+                        return false;
+                    }
+                    size /= 1024;
+                }
+                break;
+            case 'W':
+                config.write_path = optarg;
+                break;
+            case 'o':
+                config.copy_path = optarg;
+                break;
+            case 'y': {
+                bool known = false;
+                for (SyncPolicy policy : {SyncPolicy::None, SyncPolicy::Fdatasync, SyncPolicy::Fsync, SyncPolicy::Dsync}) {
+                    if (std::string(optarg) == sync_policy_name(policy)) {
+                        config.sync_policy = policy;
+                        known = true;
+                    }
+                }
+                if (!known) {
+                    std::cerr << "Unknown sync policy: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            }
+            case 'Y':
+                if (!parse_size(optarg, config.sync_interval)) {
+                    std::cerr << "Invalid sync interval: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'm':
+                config.meta_root = optarg;
+                break;
+            case 'V':
+                config.verbosity = std::atoi(optarg);
+                break;
+            case 'v':
+                config.verbosity = 2;
+                break;
+            case 'n':
+                config.meta_files = std::atoi(optarg);
+                if (config.meta_files < 1) {
+                    std::cerr << "Metadata file count must be at least 1\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'D':
+                config.meta_dirs = std::atoi(optarg);
+                if (config.meta_dirs < 1) {
+                    std::cerr << "Metadata directory count must be at least 1\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'Z':
+                if (!parse_size(optarg, config.meta_file_size) || config.meta_file_size > INT32_MAX) {
+                    std::cerr << "Invalid metadata file size: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'u':
+                config.set_dir = optarg;
+                break;
+            case 'g':
+                config.generate = true;
+                break;
+            case 'j':
+                if (std::string(optarg) == fill_pattern_name(FillPattern::Random)) {
+                    config.fill = FillPattern::Random;
+                } else if (std::string(optarg) == fill_pattern_name(FillPattern::Zero)) {
+                    config.fill = FillPattern::Zero;
+                } else {
+                    std::cerr << "Unknown fill pattern: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'K':
+                config.generate_threads = std::atoi(optarg);
+                if (config.generate_threads < 1) {
+                    std::cerr << "Generator thread count must be at least 1\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'X':
+                if (std::string(optarg) == verify_mode_name(VerifyMode::None)) {
+                    config.verify = VerifyMode::None;
+                } else if (std::string(optarg) == verify_mode_name(VerifyMode::Pattern)) {
+                    config.verify = VerifyMode::Pattern;
+                } else if (std::string(optarg) == verify_mode_name(VerifyMode::Crc32c)) {
+                    config.verify = VerifyMode::Crc32c;
+                } else {
+                    std::cerr << "Unknown verify mode: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'Q':
+                if (std::string(optarg) == verify_pass_name(VerifyPass::Inline)) {
+                    config.verify_pass = VerifyPass::Inline;
+                } else if (std::string(optarg) == verify_pass_name(VerifyPass::Separate)) {
+                    config.verify_pass = VerifyPass::Separate;
+                } else {
+                    std::cerr << "Unknown verify pass: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'J':
+                config.jsonl_path = optarg;
+                break;
+            case 'U':
+                if (!parse_rate_list(optarg, config.rates)) {
+                    std::cerr << "Invalid rate list: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case OPTION_RATE_TIME:
+                config.rate_time = std::atof(optarg);
+                if (config.rate_time <= 0) {
+                    std::cerr << "Rate time must be a positive number of seconds\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case OPTION_CREATE:
+                config.create = true;
+                break;
+            case OPTION_TRACE_FUSE:
+                config.trace_fuse = true;
+                break;
+            case OPTION_PHASES:
+                config.phases = true;
+                break;
+            case OPTION_SAMPLE_INTERVAL:
+                config.sample_interval_ms = std::atof(optarg);
+                if (config.sample_interval_ms <= 0) {
+                    std::cerr << "Sample interval must be a positive number of milliseconds\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case OPTION_CPUS:
+                if (!parse_cpu_list(optarg, config.cpus)) {
+                    std::cerr << "Invalid CPU list: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case OPTION_BUFFERS: {
+                config.buffer_strategies.clear();
+                std::string list = optarg;
+                size_t item_start = 0;
+                while (item_start <= list.size()) {
+                    size_t item_end = list.find(',', item_start);
+                    if (item_end == std::string::npos) {
+                        item_end = list.size();
+                    }
+                    std::string item = list.substr(item_start, item_end - item_start);
+                    item_start = item_end + 1;
+                    bool known = false;
+                    for (BufferStrategy strategy : {BufferStrategy::Malloc, BufferStrategy::Populate,
+                                                    BufferStrategy::Thp, BufferStrategy::Hugetlb,
+                                                    BufferStrategy::Arena}) {
+                        if (item == buffer_strategy_name(strategy)) {
+                            config.buffer_strategies.push_back(strategy);
+                            known = true;
+                        }
+                    }
+                    if (!known) {
+                        std::cerr << "Unknown buffer strategy: " << item << "\n";
+                        print_usage(argv[0]);
+                        exit_code = 1;
+                        return false;
+                    }
+                }
+                break;
+            }
+            case OPTION_MEM_NODE:
+                if (std::string(optarg) == "local") {
+                    config.mem_node = MEM_NODE_LOCAL;
+                } else {
+                    char* end;
+                    long node = std::strtol(optarg, &end, 10);
+                    if (end == optarg || *end != '\0' || node < 0 || node >= 1024) {
+                        std::cerr << "Invalid NUMA node: " << optarg << "\n";
+                        exit_code = 1;
+                        return false;
+                    }
+                    config.mem_node = (int)node;
+                }
+                break;
+            case 'I':
+                if (!parse_job_list(optarg, config.jobs)) {
+                    std::cerr << "Invalid job list: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'O': {
+                std::string label = optarg;
+                size_t equals = label.find('=');
+                if (equals == 0 || equals == std::string::npos) {
+                    std::cerr << "Invalid label, expected KEY=VALUE: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                config.labels.emplace_back(label.substr(0, equals), label.substr(equals + 1));
+                break;
+            }
+            case 'E':
+                config.set_files = std::atoi(optarg);
+                if (config.set_files < 1) {
+                    std::cerr << "File set must have at least one file\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'H':
+                if (!parse_window_list(optarg, config.set_sizes)
+                    || std::find(config.set_sizes.begin(), config.set_sizes.end(), 0) != config.set_sizes.end()) {
+                    std::cerr << "Invalid file set size list: " << optarg << "\n";
+                    exit_code = 1;
+                    return false;
+                }
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                exit_code = 0;
+                return false;
+            default:
+                print_usage(argv[0]);
+                exit_code = 1;
+                return false;
+        }
+    }
+
+    if (config.engine != Engine::Sync && config.engine != Engine::Metadata && config.engine != Engine::FileSet
+        && config.threads > 1) {
+        std::cerr << "--threads is only supported by the sync, metadata and fileset engines\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.engine == Engine::Mmap && config.pattern != AccessPattern::Sequential) {
+        std::cerr << "The mmap engine only supports the sequential pattern\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.engine == Engine::Metadata
+        && (config.cache_mode == CacheMode::Direct || config.cache_mode == CacheMode::Fadvise)) {
+        std::cerr << "The metadata engine only supports the buffered and drop_caches cache modes\n";
+        exit_code = 1;
+        return false;
+    }
+    bool tuned = config.fadvise_hints != std::vector<FadviseHint>{FadviseHint::None}
+                 || config.prefetch_windows != std::vector<long long>{0}
+                 || config.bdi_readaheads_kb != std::vector<long long>{-1};
+    if (tuned && config.engine != Engine::Sync) {
+        std::cerr << "--fadvise, --prefetch and --bdi-readahead are only supported by the sync engine\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.pattern != AccessPattern::Sequential
+        && std::any_of(config.prefetch_windows.begin(), config.prefetch_windows.end(),
+                       [](long long window) { return window > 0; })) {
+        std::cerr << "--prefetch only supports the sequential pattern\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.engine == Engine::Mmap && config.cache_mode == CacheMode::Direct) {
+        std::cerr << "The mmap engine cannot be combined with O_DIRECT\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.phases && (config.cache_mode == CacheMode::Buffered || config.cache_mode == CacheMode::Direct)
+        && config.drop_hook.empty()) {
+        std::cerr << "--phases needs --cache=fadvise, --cache=drop_caches or a --drop-hook to start cold\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.create && config.file_size == 0) {
+        std::cerr << "--create needs --file-size\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.mem_node == MEM_NODE_LOCAL && config.cpus.empty()) {
+        std::cerr << "--mem-node=local needs --cpus\n";
+        exit_code = 1;
+        return false;
+    }
+    if (!config.rates.empty() && config.engine != Engine::Sync) {
+        std::cerr << "--rate is only supported by the sync engine\n";
+        exit_code = 1;
+        return false;
+    }
+    if (!config.rates.empty()
+        && (config.verify != VerifyMode::None || config.prefetch_windows != std::vector<long long>{0})) {
+        std::cerr << "--rate cannot be combined with --verify or --prefetch\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.engine == Engine::Mixed
+        && std::none_of(config.jobs.begin(), config.jobs.end(), [](const JobClass& job) {
+               return job.kind == JobKind::Read || job.kind == JobKind::RandRead;
+           })) {
+        std::cerr << "The mixed engine needs at least one read or randread job, its runs end with the readers\n";
+        exit_code = 1;
+        return false;
+    }
+    if (config.verify != VerifyMode::None
+        && ((config.engine != Engine::Sync && config.engine != Engine::Mmap) || config.threads > 1)) {
+        std::cerr << "--verify is only supported by the single-threaded sync engine and the mmap engine\n";
+        exit_code = 1;
+        return false;
+    }
+
+    return true;
+}
+
+// Checks the test file against the configured size with fstat and fills in
+// the size when none was given
+bool validate_test_file(BenchmarkConfig& config) {
+    // The write engine creates its own file and only needs the test file for
+    // its size, the metadata and fileset engines do not use it at all
+    if ((config.engine == Engine::Write && config.file_size > 0) || config.engine == Engine::Metadata
+        || config.engine == Engine::FileSet) {
+        return true;
+    }
+
+    int test_fd = open(config.target_path.c_str(), O_RDONLY);
+    if (test_fd == -1) {
+        perror(("Could not open test file " + config.target_path).c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(test_fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+        std::cerr << config.target_path << " is not a regular file\n";
+        close(test_fd);
+        return false;
+    }
+    close(test_fd);
+
+    if (config.file_size == 0) {
+        config.file_size = st.st_size;
+    }
+    if (config.file_size == 0 || config.file_size > st.st_size) {
+        std::cerr << config.target_path << " is " << st.st_size << " bytes, cannot read "
+                  << config.file_size << " bytes from it"
+                  << (config.create ? " (remove it to have --create write a new one)\n" : "\n");
+        return false;
+    }
+    return true;
+}
+
+struct MountInfo {
+    std::string mount_point;
+    std::string fstype;
+    std::string source;
+    std::string mount_options; // Per mount point, e.g. rw,noatime
+    std::string super_options; // Per filesystem, e.g. dax=always for virtiofs
+};
+
+// Undoes the octal escapes (\040 for a space) of /proc/self/mountinfo
+std::string mountinfo_unescape(const std::string& field) {
+    std::string text;
+    for (size_t i = 0; i < field.size(); i++) {
+        if (field[i] == '\\' && i + 3 < field.size()) {
+            text += (char)std::strtol(field.substr(i + 1, 3).c_str(), NULL, 8);
+            i += 3;
+        } else {
+            text += field[i];
+        }
+    }
+    return text;
+}
+
+// Finds the mount path lives on: the longest mount point above it, preferring
+// entries of the same device so bind mounts and overlays resolve correctly
+bool find_mount(const std::string& path, MountInfo& mount) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    std::string text;
+    if (realpath(path.c_str(), resolved) == NULL || stat(resolved, &st) == -1
+        || !read_text_file("/proc/self/mountinfo", text)) {
+        return false;
+    }
+    std::string device = std::format("{}:{}", major(st.st_dev), minor(st.st_dev));
+    std::string file = resolved;
+
+    bool best_same_device = false;
+    size_t best_length = 0;
+    bool found = false;
+    size_t line_start = 0;
+    while (line_start < text.size()) {
+        size_t line_end = text.find('\n', line_start);
+        if (line_end == std::string::npos) {
+            line_end = text.size();
+        }
+        // id parent major:minor root mount_point options [optional...] - fstype source super_options
+        std::vector<std::string> fields;
+        size_t field_start = line_start;
+        while (field_start < line_end) {
+            size_t field_end = std::min(text.find(' ', field_start), line_end);
+            fields.push_back(text.substr(field_start, field_end - field_start));
+            field_start = field_end + 1;
+        }
+        line_start = line_end + 1;
+
+        auto separator = std::find(fields.begin(), fields.end(), "-");
+        if (fields.size() < 6 || fields.end() - separator < 4) {
+            continue;
+        }
+        std::string mount_point = mountinfo_unescape(fields[4]);
+        bool above = mount_point == "/" || file == mount_point
+                     || (file.compare(0, mount_point.size(), mount_point) == 0 && file[mount_point.size()] == '/');
+        bool same_device = fields[2] == device;
+        if (!above || (best_same_device && !same_device)
+            || (same_device == best_same_device && mount_point.size() < best_length)) {
+            continue;
+        }
+        mount = {mount_point, separator[1], mountinfo_unescape(separator[2]), fields[5], separator[3]};
+        best_same_device = same_device;
+        best_length = mount_point.size();
+        found = true;
+    }
+    return found;
+}
+
+// The file or directory the engine of config reads or writes
+std::string engine_data_path(const BenchmarkConfig& config) {
+    switch (config.engine) {
+        case Engine::Write:    return config.write_path;
+        case Engine::Metadata: return config.meta_root;
+        case Engine::FileSet:  return config.set_dir;
+        default:               return config.target_path;
+    }
+}
+
+// The "host" line of the JSON Lines output, written once per invocation
+std::string host_environment_json(const BenchmarkConfig& config, int argc, char** argv,
+                                  const std::string& timestamp) {
+    struct utsname host = {};
+    uname(&host);
+
+    std::string cpu_model = "unknown";
+    std::string cpuinfo;
+    if (read_text_file("/proc/cpuinfo", cpuinfo)) {
+        // x86 names the model, arm64 only the implementer and part numbers
+        for (const std::string key : {"model name", "Hardware", "CPU part"}) {
+            size_t line = cpuinfo.compare(0, key.size(), key) == 0 ? 0 : cpuinfo.find("\n" + key);
+            if (line == std::string::npos) {
+                continue;
+            }
+            size_t colon = cpuinfo.find(':', line + 1);
+            size_t end = cpuinfo.find('\n', line + 1);
+            if (colon != std::string::npos && colon < end) {
+                cpu_model = cpuinfo.substr(colon + 2, end == std::string::npos ? end : end - colon - 2);
+                break;
+            }
+        }
+    }
+
+    std::string command;
+    for (int i = 0; i < argc; i++) {
+        command += (i > 0 ? "," : "") + json_string(argv[i]);
+    }
+    std::string labels;
+    for (const auto& [key, value] : config.labels) {
+        labels += (labels.empty() ? "" : ",") + json_string(key) + ":" + json_string(value);
+    }
+
+    return std::format("{{\"record\":\"host\",\"timestamp\":{},\"hostname\":{},\"kernel\":{},\"kernel_version\":{},"
+                       "\"machine\":{},\"cpu_model\":{},\"vcpus\":{},\"git_hash\":{},\"command\":[{}],"
+                       "\"labels\":{{{}}}}}\n",
+                       json_string(timestamp), json_string(host.nodename), json_string(host.release),
+                       json_string(host.version), json_string(host.machine), json_string(cpu_model),
+                       sysconf(_SC_NPROCESSORS_ONLN), json_string(GIT_HASH), command, labels);
+}
+
+// The "target" line of the JSON Lines output: the mount the engine's data
+// lives on. For virtiofs the DAX mode is a mount option and also checked per
+// file with statx; the virtiofsd cache mode is a host-side setting the guest
+// cannot see, so it has to come in through --label.
+std::string target_environment_json(const BenchmarkConfig& config, const std::string& timestamp) {
+    std::string path = engine_data_path(config);
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, std::max<size_t>(slash, 1));
+
+    MountInfo mount;
+    bool mounted = find_mount(directory, mount);
+    std::string dax = "null";
+    if (mounted) {
+        for (const std::string& options : {mount.mount_options, mount.super_options}) {
+            std::string list = "," + options + ",";
+            size_t at = list.find(",dax");
+            if (at != std::string::npos && (list[at + 4] == ',' || list[at + 4] == '=')) {
+                size_t end = list.find(',', at + 1);
+                dax = json_string(list[at + 4] == '=' ? list.substr(at + 5, end - at - 5) : "always");
+            }
+        }
+        if (dax == "null") {
+            dax = json_string("never");
+        }
+    }
+
+    std::string file_dax = "null";
+#ifdef STATX_ATTR_DAX
+    struct statx stx;
+    if (statx(AT_FDCWD, path.c_str(), 0, STATX_BASIC_STATS, &stx) == 0
+        && (stx.stx_attributes_mask & STATX_ATTR_DAX)) {
+        file_dax = (stx.stx_attributes & STATX_ATTR_DAX) ? "true" : "false";
+    }
+#endif
+
+    auto text = [&](const std::string& value) { return mounted ? json_string(value) : std::string("null"); };
+    return std::format("{{\"record\":\"target\",\"timestamp\":{},\"target\":{},\"path\":{},\"mount_point\":{},"
+                       "\"fstype\":{},\"source\":{},\"mount_options\":{},\"super_options\":{},\"dax\":{},"
+                       "\"file_dax\":{}}}\n",
+                       json_string(timestamp), json_string(config.target_name), json_string(path),
+                       text(mount.mount_point), text(mount.fstype), text(mount.source), text(mount.mount_options),
+                       text(mount.super_options), dax, file_dax);
+}
+
+// Runs every engine configuration of one buffer strategy
+void run_matrix_point(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    if (config.verbosity >= 1) {
+        std::cout << "Starting sequential read benchmark (target: " << config.target_name
+                  << ", cache mode: " << cache_mode_name(config.cache_mode)
+                  << ", threads: " << config.threads << ", engine: " << engine_name(config.engine)
+                  << ", pattern: " << access_pattern_name(config.pattern)
+                  << ", file size: " << config.file_size << " bytes)...\n";
+    }
+    prepare_thread_files(config);
+    find_engine(config.engine)->benchmark(results, config);
+}
+
+// Runs the configured matrix against config.target_path, once per --buffers
+// strategy
+void run_matrix(std::vector<BenchmarkResult>& results, const BenchmarkConfig& config) {
+    BenchmarkConfig point = config;
+    for (BufferStrategy strategy : config.buffer_strategies) {
+        point.buffer_strategy = strategy;
+        if (config.verbosity >= 1 && config.buffer_strategies.size() > 1) {
+            std::cout << "Buffer strategy " << buffer_strategy_name(strategy) << "\n";
+        }
+        run_matrix_point(results, point);
+    }
 }
 
-int main() {
+// Points every file the engines touch into the target directory and copies
+// the test file there (reading engines only)
+BenchmarkConfig config_for_target(const BenchmarkConfig& config, const BenchmarkTarget& target) {
+    BenchmarkConfig target_config = config;
+    auto in_target = [&](const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        return target.directory + "/" + (slash == std::string::npos ? path : path.substr(slash + 1));
+    };
+    target_config.target_name = target.name;
+    target_config.target_path = in_target(config.target_path);
+    target_config.write_path = in_target(config.write_path);
+    target_config.copy_path = in_target(config.copy_path);
+    target_config.meta_root = in_target(config.meta_root);
+
+    target_config.set_dir = in_target(config.set_dir);
+
+    if (config.engine != Engine::Write && config.engine != Engine::Metadata && config.engine != Engine::FileSet) {
+        copy_test_file(config.target_path, target_config.target_path, config.file_size);
+    }
+    return target_config;
+}
+
+void generate_test_file(const BenchmarkConfig& config) {
+    auto start = std::chrono::high_resolution_clock::now();
+    generate_file(config.target_path, config.file_size, config.fill, config.generate_threads, config.seed);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (config.verbosity >= 1) {
+        std::cout << std::format("Generated {} ({} bytes, {}) in {:.3f} s, {:.1f} MB/s\n", config.target_path,
+                                 config.file_size, fill_pattern_name(config.fill), elapsed.count(),
+                                 config.file_size / (1024.0 * 1024.0) / elapsed.count());
+    }
+}
+
+// Statistics over the reported runs of every configuration, in the order
+// they ran; with them a run needs no Python in the guest, the plots can be
+// drawn on the host from the CSV later
+void print_summary(const std::vector<BenchmarkResult>& results) {
+    struct Configuration {
+        std::string key;
+        const BenchmarkResult* first;
+        std::vector<double> mbps;
+        std::vector<double> time_ms;
+        std::vector<double> p99_us;
+    };
+    std::vector<Configuration> configurations;
+    for (const BenchmarkResult& result : results) {
+        if (result.thread_id != AGGREGATE_THREAD_ID) {
+            continue;
+        }
+        std::string key = std::format("{}/{}/{}/{}/{}/{}/{}/{}", result.target, engine_name(result.engine),
+                                      result.variant, result.qd, result.threads,
+                                      buffer_strategy_name(result.buffer), run_phase_name(result.phase),
+                                      result.chunk_size);
+        auto found = std::find_if(configurations.begin(), configurations.end(),
+                                  [&](const Configuration& configuration) { return configuration.key == key; });
+        if (found == configurations.end()) {
+            configurations.push_back({key, &result, {}, {}, {}});
+            found = configurations.end() - 1;
+        }
+        found->mbps.push_back(result.throughput_mbps);
+        found->time_ms.push_back(result.read_time_ms);
+        if (result.latency.valid) {
+            found->p99_us.push_back(result.latency.p99_us);
+        }
+    }
+    if (configurations.empty()) {
+        return;
+    }
+
+    std::cout << "\n=== Summary ===\n"
+              << std::format("{:<32} {:>6} {:>4} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "configuration",
+                             "chunk", "runs", "mean MB/s", "median", "std", "p5", "p95", "median ms", "p99 us");
+    for (Configuration& configuration : configurations) {
+        const BenchmarkResult& first = *configuration.first;
+        std::string name = engine_name(first.engine);
+        for (const std::string& part : {first.target, first.variant, std::string(run_phase_name(first.phase))}) {
+            if (!part.empty() && part != "default") {
+                name += "/" + part;
+            }
+        }
+        if (first.qd > 1) {
+            name += std::format("/qd={}", first.qd);
+        }
+        if (first.threads > 1) {
+            name += std::format("/threads={}", first.threads);
+        }
+        if (first.buffer != BufferStrategy::Malloc) {
+            name += std::string("/") + buffer_strategy_name(first.buffer);
+        }
+
+        std::vector<double>& mbps = configuration.mbps;
+        double mean = 0;
+        for (double value : mbps) {
+            mean += value;
+        }
+        mean /= mbps.size();
+        double variance = 0;
+        for (double value : mbps) {
+            variance += (value - mean) * (value - mean);
+        }
+        double std_dev = mbps.size() > 1 ? std::sqrt(variance / (mbps.size() - 1)) : 0;
+        std::sort(mbps.begin(), mbps.end());
+        std::sort(configuration.time_ms.begin(), configuration.time_ms.end());
+        std::sort(configuration.p99_us.begin(), configuration.p99_us.end());
+        std::string p99 = configuration.p99_us.empty() ? "-"
+                          : std::format("{:.1f}", quantile(configuration.p99_us, 0.5));
+
+        std::cout << std::format("{:<32} {:>6} {:>4} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.3f}"
+                                 " {:>10}\n", name, size_label(first.chunk_size), mbps.size(), mean, quantile(mbps, 0.5), std_dev,
+                                 quantile(mbps, 0.05), quantile(mbps, 0.95), quantile(configuration.time_ms, 0.5),
+                                 p99);
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchmarkConfig config;
+    int exit_code;
+    if (!parse_arguments(argc, argv, config, exit_code)) {
+        return exit_code;
+    }
+    if (config.generate) {
+        if (config.file_size == 0) {
+            std::cerr << "--generate needs --file-size\n";
+            return 1;
+        }
+        generate_test_file(config);
+        return 0;
+    }
+    if (config.create && access(config.target_path.c_str(), F_OK) == -1) {
+        generate_test_file(config);
+    }
+    if (!validate_test_file(config)) {
+        return 1;
+    }
+
     // Open data output file
     int data_fd = open("benchmark_results.csv", O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if (data_fd == -1) {
         perror("Could not open output file");
         return 1;
     }
-    
-    // Write CSV header
-    std::string header = "chunk_size,run_number,read_time_ms,throughput_mbps\n";
-    ssize_t header_written = write(data_fd, header.data(), header.size());
-    if (header_written != header.size()) {
-        fprintf(stderr, "Error writing CSV header\n");
+    int jsonl_fd = -1;
+    if (!config.jsonl_path.empty()) {
+        jsonl_fd = open(config.jsonl_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (jsonl_fd == -1) {
+            perror("Could not open JSON Lines output file");
+            return 1;
+        }
+    }
+
+    // Single-threaded engines read on the main thread, worker 0
+    pin_worker(config, pthread_self(), 0);
+
+    // Every line of one invocation carries its start time, which ties the
+    // results to their host and target lines in a database
+    char timestamp[32];
+    std::time_t now = std::time(NULL);
+    struct tm utc;
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime_r(&now, &utc));
+    std::string environment = host_environment_json(config, argc, argv, timestamp);
+
+    // Rows are kept in memory until the end, reserve for the whole matrix
+    std::vector<BenchmarkResult> results;
+    size_t runs_per_config = config.runs * (config.threads > 1 ? config.threads + 1 : 1);
+    if (config.engine == Engine::IoUring) {
+        runs_per_config *= config.queue_depths.size();
+    }
+    if (config.engine == Engine::Preadv) {
+        runs_per_config *= config.iovec_counts.size() * config.rwf_flags.size();
+    }
+    if (config.engine == Engine::Sync) {
+        runs_per_config *= read_tunings(config).size();
+    }
+    if (config.engine == Engine::Mixed) {
+        runs_per_config *= config.jobs.size();
+    }
+    if (!config.rates.empty()) {
+        runs_per_config *= config.rates.size();
+    }
+    runs_per_config *= config.buffer_strategies.size();
+    results.reserve(std::max<size_t>(1, config.targets.size())
+                    * (config.engine == Engine::Metadata ? config.runs * 5
+                       : config.engine == Engine::Mmap ? config.runs
+                       : runs_per_config * config.chunk_sizes.size()));
+
+    if (config.targets.empty()) {
+        run_matrix(results, config);
+        environment += target_environment_json(config, timestamp);
+    }
+    for (const BenchmarkTarget& target : config.targets) {
+        BenchmarkConfig target_config = config_for_target(config, target);
+        run_matrix(results, target_config);
+        environment += target_environment_json(target_config, timestamp);
+    }
+
+    // Write all results in one go and close output file
+    if (!write_results(data_fd, results)) {
+        perror("Error writing results to file");
         close(data_fd);
         return 1;
     }
-    
-    std::cout << "Starting sequential read benchmark...\n";
-    
-    // Benchmark small reads (100 bytes)
-    std::cout << "Testing small reads (100 bytes)\n";
-    benchmark_chunk_size(SMALL_CHUNK, data_fd);
-    
-    // Benchmark medium reads (1K)
-    std::cout << "Testing medium reads (1K)\n";
-    benchmark_chunk_size(MEDIUM_CHUNK, data_fd);
-    
-    // Benchmark large reads (64K)
-    std::cout << "Testing incremental reads of 8KiB starting from 8KiB up to 256KiB\n";
-    for (int incremental_chunk_size = INCREMENTAL_START; 
-        incremental_chunk_size <= LARGEST_CHUNK; 
-        incremental_chunk_size +=INCREMENTAL)
-    {
-        benchmark_chunk_size(incremental_chunk_size, data_fd);
-    }  
-    
-    // Close output file
     if (close(data_fd) == -1) {
-        std::cout << "Error closing output file\n";
+        std::cerr << "Error closing output file\n";
         return 1;
     }
+    if (config.sample_interval_ms > 0) {
+        int series_fd = open("benchmark_timeseries.csv", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (series_fd == -1 || !write_timeseries(series_fd, results) || close(series_fd) == -1) {
+            perror("Error writing time series file");
+            return 1;
+        }
+    }
+    if (jsonl_fd != -1) {
+        for (const BenchmarkResult& result : results) {
+            format_result_json(environment, result, timestamp);
+        }
+        if (!write_all(jsonl_fd, environment) || close(jsonl_fd) == -1) {
+            perror("Error writing JSON Lines output file");
+            return 1;
+        }
+    }
     
-    std::cout << "Benchmark completed. Results saved to benchmark_results.csv\n";
+    if (config.verbosity >= 1) {
+        print_summary(results);
+        std::cout << "Benchmark completed. Results saved to benchmark_results.csv\n";
+    }
+
+    // The numbers of a run that returned wrong data are not worth comparing
+    long long corrupt_reads = 0;
+    for (const BenchmarkResult& result : results) {
+        corrupt_reads += result.verify.corrupt_reads;
+    }
+    if (corrupt_reads > 0) {
+        std::cerr << "Data verification failed: " << corrupt_reads << " corrupt reads\n";
+        return 1;
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@ Sequential Read Benchmark Orchestration Script
 Creates test files, runs benchmark, and generates performance plots.
 """
 
+import math
 import os
 import subprocess
 import pandas as pd
@@ -17,26 +18,34 @@ FILE_SIZE_MB = 1
 FILE_SIZE_BYTES = FILE_SIZE_MB * 1024 * 1024
 TEST_FILE_NAME = "test_file.bin"
 RESULTS_FILE = "benchmark_results.csv"
+TIMESERIES_FILE = "benchmark_timeseries.csv"
+
+# Regression gate defaults (compare mode)
+MAX_THROUGHPUT_DROP_PCT = 5.0
+MAX_P99_RISE_PCT = 10.0
+SIGNIFICANCE = 0.01
+
+# Columns identifying one configuration of the sweep, as far as a results file has them
+COMPARE_KEYS = ['target', 'engine', 'variant', 'qd', 'threads', 'pattern', 'cache_mode', 'buffer', 'phase',
+                'chunk_size']
 BENCHMARK_ELF = "seq_read_bench.elf.bin"
 
+def format_size(size):
+    """Readable binary size label, e.g. 100B, 8KiB or 4MiB."""
+    for unit, scale in (("GiB", 1 << 30), ("MiB", 1 << 20), ("KiB", 1 << 10)):
+        if size >= scale and size % scale == 0:
+            return f"{size // scale}{unit}"
+    return f"{size}B"
+
 def create_test_file():
-    # Create a 1MiB test file with random data
+    """Generate the test file with the benchmark binary (random, incompressible data)."""
     print(f"Creating {FILE_SIZE_MB}MiB test file: {TEST_FILE_NAME}")
-    
-    # Generate random data
-    with open(TEST_FILE_NAME, "wb") as f:
-        # Write in 64KB chunks to avoid memory issues
-        chunk_size = 64 * 1024
-        remaining = FILE_SIZE_BYTES
-        
-        while remaining > 0:
-            write_size = min(chunk_size, remaining)
-            # Create pseudo-random data (simple pattern to avoid /dev/urandom dependency)
-            data = bytearray(write_size)
-            for i in range(write_size):
-                data[i] = (i * 73 + 17) & 0xFF  # Simple pseudo-random pattern
-            f.write(data)
-            remaining -= write_size
+
+    # Extra arguments (e.g. --file-size=10G, --fill=zero, --gen-threads=4) apply here too,
+    # except --target: a test file given by the user is never overwritten
+    command = ["./seq_read_bench", "--generate", f"--file-size={FILE_SIZE_BYTES}", *sys.argv[1:],
+               f"--target={TEST_FILE_NAME}"]
+    subprocess.run(command, check=True)
 
     print(f"Test file created successfully ({os.path.getsize(TEST_FILE_NAME)} bytes)")
 
@@ -47,7 +56,12 @@ def run_benchmark():
     try:
         # Execute the benchmark
         print("Executing the benchmark 🍾")
-        result = subprocess.run(["./seq_read_bench"], timeout=20)
+        # Extra command line arguments (e.g. --cache=direct) are passed through
+        # and can override the file size of the generated test file
+        command = ["./seq_read_bench", f"--file-size={FILE_SIZE_BYTES}", f"--target={TEST_FILE_NAME}",
+                   *sys.argv[1:]]
+        # No timeout: large test files and time budgets legitimately run for long
+        result = subprocess.run(command)
 
         if result.returncode != 0:
             print(f"Benchmark failed with return code {result.returncode}")
@@ -59,17 +73,14 @@ def run_benchmark():
         print(f"Output: {result.stdout}")
         return True
         
-    except subprocess.TimeoutExpired:
-        print("Benchmark timed out after 5 minutes")
-        return False
     except Exception as e:
         print(f"Error running benchmark: {e}")
         return False
 
-def load_and_validate_results():
+def load_and_validate_results(results_file=RESULTS_FILE):
     """Load benchmark results and validate data."""    
     try:
-        df = pd.read_csv(RESULTS_FILE)
+        df = pd.read_csv(results_file)
         print(f"Loaded {len(df)} benchmark results")
         
         # Validate expected columns
@@ -93,6 +104,27 @@ def load_and_validate_results():
         print(f"Error loading results: {e}")
         return None
 
+def draw_median_ci(ax, df_plot, low_col, high_col, hue):
+    """Draw the 95% confidence interval of the median of every box as an error bar."""
+    if low_col not in df_plot.columns or df_plot[low_col].isna().all():
+        return
+    hue_levels = list(dict.fromkeys(df_plot[hue])) if hue else [None]
+    width = 0.8 / len(hue_levels)
+    for i, label in enumerate(df_plot['chunk_label'].cat.categories):
+        for j, level in enumerate(hue_levels):
+            rows = df_plot[df_plot['chunk_label'] == label]
+            if hue:
+                rows = rows[rows[hue] == level]
+            rows = rows.dropna(subset=[low_col, high_col])
+            if rows.empty:
+                continue
+            # Boxes of several hue levels are dodged side by side
+            x = i if hue is None else i - 0.4 + (j + 0.5) * width
+            low = rows[low_col].median()
+            high = rows[high_col].median()
+            ax.errorbar(x, (low + high) / 2, yerr=(high - low) / 2, fmt='none',
+                        ecolor='black', elinewidth=2, capsize=6, zorder=5)
+
 def generate_plots(df):
     """Generate boxplots for benchmark results."""
     print("Generating performance plots...")
@@ -102,29 +134,40 @@ def generate_plots(df):
     sns.set_palette("husl")
     
     # Create figure with subplots
-    fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(15, 6))
+    fig, (ax1, ax2, ax3) = plt.subplots(1, 3, figsize=(22, 6))
     
+    # Per-thread rows of parallel runs are summarized by their aggregate row
+    if 'thread_id' in df.columns:
+        df = df[df['thread_id'] == -1]
+
     # Prepare data with readable chunk size labels
     df_plot = df.copy()
 
-    chunk_size_map = {
-        100: "100B",
-        1024: "1KiB"
-    }
-    for i in range(1, 33):
-        size = i * 8192
-        chunk_size_map[size] = f"{8*i}KiB"
-    expected_chunk_sizes = [100, 1024]
-    expected_chunk_sizes.extend([8192 * i for i in range(1, 33)])
+    expected_chunk_sizes = sorted(df['chunk_size'].unique())
+    chunk_size_map = {chunk: format_size(chunk) for chunk in expected_chunk_sizes}
 
-    df_plot['chunk_label'] = df_plot['chunk_size'].map(chunk_size_map)
+    df_plot['chunk_label'] = pd.Categorical(df_plot['chunk_size'].map(chunk_size_map),
+                                            categories=[chunk_size_map[c] for c in expected_chunk_sizes],
+                                            ordered=True)
     
+    # Runs against several targets get one box per target, the cold and warm
+    # runs of --phases one box per phase
+    several_targets = 'target' in df_plot.columns and df_plot['target'].nunique() > 1
+    phase_split = 'phase' in df_plot.columns and df_plot['phase'].nunique() > 1
+    hue = 'target' if several_targets else None
+    if phase_split:
+        df_plot['series'] = df_plot['target'] + ': ' + df_plot['phase'] if several_targets else df_plot['phase']
+        hue = 'series'
+        # The annotated medians and the summary below describe the warm runs
+        df = df[df['phase'] == 'warm']
+
     # Plot 1: Read Time
-    sns.boxplot(data=df_plot, x='chunk_label', y='read_time_ms', ax=ax1)
+    sns.boxplot(data=df_plot, x='chunk_label', y='read_time_ms', hue=hue, ax=ax1)
     ax1.set_title('Sequential Read Performance - Read Time', fontsize=14, fontweight='bold')
     ax1.set_xlabel('Chunk Size', fontsize=12)
     ax1.set_ylabel('Read Time (ms)', fontsize=12)
     ax1.grid(True, alpha=0.3)
+    draw_median_ci(ax1, df_plot, 'ci_low_ms', 'ci_high_ms', hue)
     
     # Add statistics to read time plot
     for i, chunk in enumerate(expected_chunk_sizes):
@@ -135,11 +178,12 @@ def generate_plots(df):
                 bbox=dict(boxstyle='round,pad=0.3', facecolor='white', alpha=0.8))
     
     # Plot 2: Throughput
-    sns.boxplot(data=df_plot, x='chunk_label', y='throughput_mbps', ax=ax2)
+    sns.boxplot(data=df_plot, x='chunk_label', y='throughput_mbps', hue=hue, ax=ax2)
     ax2.set_title('Sequential Read Performance - Throughput', fontsize=14, fontweight='bold')
     ax2.set_xlabel('Chunk Size', fontsize=12)
     ax2.set_ylabel('Throughput (MB/s)', fontsize=12)
     ax2.grid(True, alpha=0.3)
+    draw_median_ci(ax2, df_plot, 'ci_low_mbps', 'ci_high_mbps', hue)
     
     # Add statistics to throughput plot
     for i, chunk in enumerate(expected_chunk_sizes):
@@ -149,6 +193,28 @@ def generate_plots(df):
                 ha='center', va='bottom', fontweight='bold',
                 bbox=dict(boxstyle='round,pad=0.3', facecolor='white', alpha=0.8))
     
+    # Plot 3: Per-read latency percentiles (median over runs)
+    latency_cols = {
+        'lat_p50_us': 'p50',
+        'lat_p90_us': 'p90',
+        'lat_p99_us': 'p99',
+        'lat_p999_us': 'p99.9',
+        'lat_max_us': 'max',
+    }
+    if all(col in df_plot.columns for col in latency_cols) and df_plot['lat_p50_us'].notna().any():
+        label_order = [chunk_size_map[chunk] for chunk in expected_chunk_sizes]
+        latency_medians = df_plot.groupby('chunk_label', observed=True)[list(latency_cols)].median()
+        latency_medians = latency_medians.reindex([l for l in label_order if l in latency_medians.index])
+        for col, name in latency_cols.items():
+            ax3.plot(latency_medians.index, latency_medians[col], marker='o', label=name)
+        ax3.set_yscale('log')
+        ax3.legend()
+    ax3.set_title('Sequential Read Performance - Read Latency', fontsize=14, fontweight='bold')
+    ax3.set_xlabel('Chunk Size', fontsize=12)
+    ax3.set_ylabel('Latency per read (us)', fontsize=12)
+    ax3.tick_params(axis='x', rotation=90)
+    ax3.grid(True, alpha=0.3)
+
     plt.tight_layout()
     
     # Save the plot
@@ -169,6 +235,280 @@ def generate_plots(df):
         print(f"  Throughput - Mean: {chunk_data['throughput_mbps'].mean():.2f}MB/s, "
               f"Median: {chunk_data['throughput_mbps'].median():.2f}MB/s, "
               f"Std: {chunk_data['throughput_mbps'].std():.2f}MB/s")
+        if 'ci_low_mbps' in chunk_data.columns and chunk_data['ci_low_mbps'].notna().any():
+            print(f"  Median 95% CI - {chunk_data['ci_low_mbps'].median():.2f}.."
+                  f"{chunk_data['ci_high_mbps'].median():.2f}MB/s, "
+                  f"{len(chunk_data)} runs, {int(chunk_data['outlier'].sum())} outliers")
+        if phase_split:
+            cold_data = df_plot[(df_plot['chunk_size'] == chunk) & (df_plot['phase'] == 'cold')]
+            print(f"  Cold run - Median: {cold_data['read_time_ms'].median():.2f}ms, "
+                  f"{cold_data['throughput_mbps'].median():.2f}MB/s, "
+                  f"time to first byte: {cold_data['ttfb_us'].median():.1f}us "
+                  f"(warm {chunk_data['ttfb_us'].median():.1f}us)")
+        if 'fuse_reads' in chunk_data.columns and chunk_data['fuse_reads'].notna().any():
+            print(f"  FUSE - {chunk_data['fuse_reads'].median():.0f} READs "
+                  f"of {chunk_data['fuse_read_kib'].median():.1f}KiB, "
+                  f"{chunk_data['fuse_requests'].median():.0f} requests, "
+                  f"{chunk_data['vq_irqs_per_mib'].median():.2f} virtqueue interrupts/MiB")
+        if 'lat_p99_us' in chunk_data.columns and chunk_data['lat_p99_us'].notna().any():
+            print(f"  Latency - p50: {chunk_data['lat_p50_us'].median():.2f}us, "
+                  f"p99: {chunk_data['lat_p99_us'].median():.2f}us, "
+                  f"p99.9: {chunk_data['lat_p999_us'].median():.2f}us, "
+                  f"max: {chunk_data['lat_max_us'].max():.2f}us")
+
+def generate_overhead_plot(df):
+    """Plot the throughput overhead of every target relative to the first (baseline) target."""
+    if 'target' not in df.columns or df['target'].nunique() < 2:
+        return
+
+    df = df[df['thread_id'] == -1] if 'thread_id' in df.columns else df
+    targets = list(dict.fromkeys(df['target']))
+    baseline = targets[0]
+    medians = df.groupby(['target', 'chunk_size'])['throughput_mbps'].median().unstack('target')
+    chunk_labels = [format_size(chunk) for chunk in medians.index]
+
+    fig, ax = plt.subplots(figsize=(15, 6))
+    print(f"\n=== OVERHEAD RELATIVE TO {baseline} (baseline throughput / target throughput) ===")
+    for target in targets[1:]:
+        ratio = medians[baseline] / medians[target]
+        ax.plot(chunk_labels, ratio.values, marker='o', label=target)
+        for label, value in zip(chunk_labels, ratio.values):
+            print(f"  {target} {label}: {value:.2f}x")
+    ax.axhline(1.0, color='gray', linestyle='--', linewidth=1)
+    ax.set_title(f'Throughput Overhead vs {baseline}', fontsize=14, fontweight='bold')
+    ax.set_xlabel('Chunk Size', fontsize=12)
+    ax.set_ylabel(f'{baseline} / target median throughput', fontsize=12)
+    ax.tick_params(axis='x', rotation=90)
+    ax.grid(True, alpha=0.3)
+    ax.legend()
+
+    plt.tight_layout()
+    output_file = "overhead_ratio.png"
+    plt.savefig(output_file, dpi=300, bbox_inches='tight')
+    print(f"Plot saved as: {output_file}")
+
+def generate_readahead_heatmap(df):
+    """Heatmap of median throughput by chunk size and readahead tuning (--fadvise/--prefetch/--bdi-readahead)."""
+    if 'variant' not in df.columns or 'engine' not in df.columns:
+        return
+    df = df[(df['engine'] == 'sync') & (df['thread_id'] == -1)].copy()
+    df['variant'] = df['variant'].fillna('').replace('', 'default')
+    # Open-loop runs are plotted by generate_load_curve
+    df = df[~df['variant'].str.contains('rate=', regex=False)]
+    if df['variant'].nunique() < 2:
+        return
+
+    # Several targets get one row per target and tuning
+    if df['target'].nunique() > 1:
+        df['variant'] = df['target'] + ': ' + df['variant']
+    medians = df.groupby(['variant', 'chunk_size'])['throughput_mbps'].median().unstack('chunk_size')
+    medians = medians.reindex(list(dict.fromkeys(df['variant'])))
+    medians.columns = [format_size(chunk) for chunk in medians.columns]
+
+    fig, ax = plt.subplots(figsize=(max(8, 0.6 * len(medians.columns) + 4), max(4, 0.5 * len(medians) + 2)))
+    sns.heatmap(medians, annot=True, fmt='.0f', cmap='viridis', cbar_kws={'label': 'Median throughput (MB/s)'}, ax=ax)
+    ax.set_title('Sequential Read Throughput by Readahead Tuning', fontsize=14, fontweight='bold')
+    ax.set_xlabel('Chunk Size', fontsize=12)
+    ax.set_ylabel('Readahead tuning', fontsize=12)
+
+    plt.tight_layout()
+    output_file = "readahead_heatmap.png"
+    plt.savefig(output_file, dpi=300, bbox_inches='tight')
+    print(f"Plot saved as: {output_file}")
+
+def generate_load_curve(df):
+    """Achieved throughput vs p99 latency of the open-loop sweep (--rate), one line per chunk size."""
+    if 'variant' not in df.columns or 'lat_p99_us' not in df.columns:
+        return
+    df = df[(df['thread_id'] == -1) & df['variant'].fillna('').str.contains('rate=', regex=False)].copy()
+    if df.empty:
+        return
+
+    # Medians per offered load, in the order the loads were swept
+    df['load'] = df['variant'].str.extract(r'(rate=[^/]+)')[0]
+    points = df.groupby(['target', 'chunk_size', 'load'], sort=False).agg(
+        throughput_mbps=('throughput_mbps', 'median'), lat_p99_us=('lat_p99_us', 'median')).reset_index()
+
+    fig, ax = plt.subplots(figsize=(10, 6))
+    several_targets = points['target'].nunique() > 1
+    for (target, chunk), curve in points.groupby(['target', 'chunk_size'], sort=False):
+        curve = curve.sort_values('throughput_mbps')
+        label = f"{target}: {format_size(chunk)}" if several_targets else format_size(chunk)
+        ax.plot(curve['throughput_mbps'], curve['lat_p99_us'], marker='o', label=label)
+    ax.set_yscale('log')
+    ax.set_title('Latency Under Load (open loop)', fontsize=14, fontweight='bold')
+    ax.set_xlabel('Achieved throughput (MB/s)', fontsize=12)
+    ax.set_ylabel('p99 latency from intended start (µs)', fontsize=12)
+    ax.legend(title='Chunk Size')
+    ax.grid(True, alpha=0.3)
+
+    plt.tight_layout()
+    output_file = "latency_under_load.png"
+    plt.savefig(output_file, dpi=300, bbox_inches='tight')
+    print(f"Plot saved as: {output_file}")
+
+def generate_timeseries_plot(timeseries_file=TIMESERIES_FILE):
+    """Interval throughput over the time of each run (--sample-interval), one panel per chunk size."""
+    if not os.path.exists(timeseries_file):
+        return
+    df = pd.read_csv(timeseries_file)
+    if df.empty:
+        return
+    df['variant'] = df['variant'].fillna('')
+
+    chunk_sizes = sorted(df['chunk_size'].unique())
+    fig, axes = plt.subplots(len(chunk_sizes), 1, figsize=(12, 3 * len(chunk_sizes) + 1), squeeze=False)
+    several_series = df.groupby(['target', 'engine', 'variant', 'buffer']).ngroups > 1
+    for ax, chunk in zip(axes[:, 0], chunk_sizes):
+        chunk_df = df[df['chunk_size'] == chunk]
+        for (target, engine, variant, buffer, run), series in chunk_df.groupby(
+                ['target', 'engine', 'variant', 'buffer', 'run_number'], sort=False):
+            name = f"{target}/{engine}{'/' + variant if variant else ''}/{buffer} " if several_series else ""
+            ax.plot(series['time_ms'], series['interval_mbps'], linewidth=1, label=f"{name}run {run}")
+        ax.set_title(f"{format_size(chunk)} chunks", fontsize=12)
+        ax.set_ylabel('Throughput (MB/s)', fontsize=10)
+        ax.grid(True, alpha=0.3)
+        if chunk_df.groupby(['target', 'engine', 'variant', 'buffer', 'run_number']).ngroups <= 10:
+            ax.legend(fontsize=8)
+    axes[-1, 0].set_xlabel('Time into run (ms)', fontsize=12)
+    fig.suptitle('Throughput Within Runs', fontsize=14, fontweight='bold')
+
+    plt.tight_layout()
+    output_file = "throughput_timeseries.png"
+    plt.savefig(output_file, dpi=300, bbox_inches='tight')
+    print(f"Plot saved as: {output_file}")
+
+def mann_whitney_less(current, baseline):
+    """One-sided Mann-Whitney U test that current tends to be smaller than baseline.
+
+    Normal approximation with tie correction, good enough from about 8 runs per side.
+    Returns the p-value, 1.0 when either side has no values.
+    """
+    n1, n2 = len(current), len(baseline)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    values = pd.concat([pd.Series(current, dtype=float), pd.Series(baseline, dtype=float)], ignore_index=True)
+    ranks = values.rank()
+    u = ranks[:n1].sum() - n1 * (n1 + 1) / 2
+    n = n1 + n2
+    ties = values.value_counts()
+    variance = n1 * n2 / 12 * ((n + 1) - ((ties ** 3 - ties).sum() / (n * (n - 1))))
+    if variance <= 0:
+        return 1.0
+    # Continuity correction towards the mean
+    z = (u - n1 * n2 / 2 + 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(-z / math.sqrt(2))
+
+def aggregate_rows(df):
+    """Rows summarizing a whole run, the ones compared between results files."""
+    if 'thread_id' in df.columns:
+        df = df[df['thread_id'] == -1]
+    df = df.copy()
+    for key in ('variant', 'phase', 'target', 'buffer'):
+        if key in df.columns:
+            df[key] = df[key].fillna('')
+    return df
+
+def compare_results(baseline_file, current_file, max_drop_pct, max_p99_rise_pct, alpha):
+    """Compare every configuration of current_file with baseline_file.
+
+    A configuration regresses when its median throughput dropped by more than max_drop_pct
+    or its median p99 latency rose by more than max_p99_rise_pct, and a one-sided
+    Mann-Whitney test over the runs rejects "no change" at alpha. Returns the exit code:
+    0 when nothing regressed, 1 on a regression, 2 when the files share no configuration.
+    """
+    baseline = aggregate_rows(pd.read_csv(baseline_file))
+    current = aggregate_rows(pd.read_csv(current_file))
+    keys = [key for key in COMPARE_KEYS if key in baseline.columns and key in current.columns]
+    has_p99 = 'lat_p99_us' in baseline.columns and 'lat_p99_us' in current.columns
+
+    # Older pandas yields scalar group names for a single key
+    as_tuple = lambda group: group if isinstance(group, tuple) else (group,)
+    rows = []
+    baseline_groups = {as_tuple(group): group_rows
+                       for group, group_rows in baseline.groupby(keys, sort=False, dropna=False)}
+    for group, now in current.groupby(keys, sort=False, dropna=False):
+        group = as_tuple(group)
+        before = baseline_groups.get(group)
+        if before is None:
+            continue
+        config = dict(zip(keys, group))
+        row = {
+            'config': '/'.join(str(config[key]) for key in keys if key != 'chunk_size' and config[key] != ''),
+            'chunk': format_size(int(config['chunk_size'])),
+            'runs': f"{len(before)}/{len(now)}",
+            'base_mbps': before['throughput_mbps'].median(),
+            'mbps': now['throughput_mbps'].median(),
+        }
+        row['mbps_delta_pct'] = 100.0 * (row['mbps'] / row['base_mbps'] - 1)
+        row['mbps_p'] = mann_whitney_less(now['throughput_mbps'], before['throughput_mbps'])
+        slower = row['mbps_delta_pct'] < -max_drop_pct and row['mbps_p'] < alpha
+
+        row['p99_delta_pct'] = math.nan
+        row['p99_p'] = math.nan
+        higher = False
+        if has_p99 and before['lat_p99_us'].notna().any() and now['lat_p99_us'].notna().any():
+            base_p99 = before['lat_p99_us'].median()
+            row['p99_delta_pct'] = 100.0 * (now['lat_p99_us'].median() / base_p99 - 1)
+            # A rise of the current p99 is a drop of its negation
+            row['p99_p'] = mann_whitney_less(-now['lat_p99_us'].dropna(), -before['lat_p99_us'].dropna())
+            higher = row['p99_delta_pct'] > max_p99_rise_pct and row['p99_p'] < alpha
+        row['verdict'] = 'REGRESSION' if slower or higher else 'ok'
+        rows.append(row)
+
+    if not rows:
+        print(f"No configuration of {current_file} is in {baseline_file}")
+        return 2
+
+    table = pd.DataFrame(rows)
+    print(f"=== {current_file} vs baseline {baseline_file} ===")
+    print(f"Gate: throughput -{max_drop_pct:g}%, p99 +{max_p99_rise_pct:g}%, one-sided Mann-Whitney p < {alpha:g}")
+    print(table.to_string(index=False, float_format=lambda value: f"{value:.3f}"))
+    regressions = (table['verdict'] == 'REGRESSION').sum()
+    if regressions:
+        print(f"\n{regressions} of {len(table)} configurations regressed")
+        return 1
+    print(f"\nNo regression in {len(table)} configurations")
+    return 0
+
+def compare_main(args):
+    """Compare mode: seq_read_bench.py --compare BASELINE [CURRENT] [--max-drop=PCT] [--max-p99-rise=PCT]
+    [--alpha=P]. CURRENT defaults to the results file of the last run."""
+    files = []
+    max_drop_pct, max_p99_rise_pct, alpha = MAX_THROUGHPUT_DROP_PCT, MAX_P99_RISE_PCT, SIGNIFICANCE
+    for arg in args:
+        if arg.startswith('--max-drop='):
+            max_drop_pct = float(arg.split('=', 1)[1])
+        elif arg.startswith('--max-p99-rise='):
+            max_p99_rise_pct = float(arg.split('=', 1)[1])
+        elif arg.startswith('--alpha='):
+            alpha = float(arg.split('=', 1)[1])
+        else:
+            files.append(arg)
+    if len(files) not in (1, 2):
+        print(compare_main.__doc__)
+        return 2
+    return compare_results(files[0], files[1] if len(files) == 2 else RESULTS_FILE,
+                           max_drop_pct, max_p99_rise_pct, alpha)
+
+def draw_all_plots(df, timeseries_file=TIMESERIES_FILE):
+    """Every plot the results support."""
+    generate_plots(df)
+    generate_overhead_plot(df)
+    generate_readahead_heatmap(df)
+    generate_load_curve(df)
+    generate_timeseries_plot(timeseries_file)
+
+def plot_main(args):
+    """Plot mode: seq_read_bench.py --plot [RESULTS]. Draws the plots of results exported from a
+    guest (default benchmark_results.csv, with benchmark_timeseries.csv next to it) without running
+    anything, so the plotting libraries are only needed on the host."""
+    results_file = args[0] if args else RESULTS_FILE
+    df = load_and_validate_results(results_file)
+    if df is None:
+        return 1
+    draw_all_plots(df, os.path.join(os.path.dirname(results_file), TIMESERIES_FILE))
+    return 0
 
 def main():
     """Main orchestration function."""
@@ -190,10 +530,10 @@ def main():
             return 1
         
         # Step 4: Generate plots
-        generate_plots(df)
+        draw_all_plots(df)
         
         print("\n=== Benchmark completed successfully! ===")
-        print(f"Results saved in: fs/{RESULTS_FILE}")
+        print(f"Results saved in: {RESULTS_FILE}")
         print(f"Plots saved as: read_benchmark_results.png")
         
         return 0
@@ -206,5 +546,9 @@ def main():
         return 1
 
 if __name__ == "__main__":
+    if len(sys.argv) > 1 and sys.argv[1] == '--compare':
+        sys.exit(compare_main(sys.argv[2:]))
+    if len(sys.argv) > 1 and sys.argv[1] == '--plot':
+        sys.exit(plot_main(sys.argv[2:]))
     exit_code = main()
     sys.exit(exit_code)